@@ -0,0 +1,150 @@
+/*! @file BinaryReader.h
+ *  Class decleration of LapH::BinaryReader
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _BINARY_READER_H_
+#define _BINARY_READER_H_
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "global_data_typedefs.h"
+
+namespace LapH {
+
+/*! Alignment of buffers, offsets and sizes for O_DIRECT. 4096 covers all
+ *  logical block sizes in use
+ */
+const size_t direct_alignment = 4096;
+
+/*! Allocator returning memory aligned to direct_alignment
+ *
+ *  BinaryReader reads into such buffers without a bounce buffer, apart from
+ *  the unaligned head and tail of the requested range.
+ */
+template <typename T> struct DirectAllocator {
+  typedef T value_type;
+
+  DirectAllocator() {}
+  template <typename U> DirectAllocator(const DirectAllocator<U>&) {}
+
+  T* allocate(const size_t n) {
+    void* p = NULL;
+    if(posix_memalign(&p, direct_alignment, n * sizeof(T)) != 0)
+      throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+  void deallocate(T* p, const size_t) {
+    free(p);
+  }
+};
+template <typename T, typename U>
+inline bool operator==(const DirectAllocator<T>&, const DirectAllocator<U>&) {
+  return true;
+}
+template <typename T, typename U>
+inline bool operator!=(const DirectAllocator<T>&, const DirectAllocator<U>&) {
+  return false;
+}
+
+/*! Byte buffer for BinaryReader aligned for O_DIRECT */
+typedef std::vector<char, DirectAllocator<char> > DirectBuffer;
+
+/*! Reads flat binary files with many outstanding requests
+ *
+ *  Reads are first collected with queue() and then issued together by wait().
+ *  Two backends exist:
+ *  - pread:    the requests are processed one after another with pread(2)
+ *  - io_uring: all requests are submitted to the kernel at once. Only
+ *              available if the code was compiled with HAVE_IO_URING, at
+ *              runtime it falls back to pread if the kernel does not support
+ *              it.
+ *
+ *  With O_DIRECT the page cache is bypassed. If the buffer and the offset 
+ *  have the same misalignment, the aligned middle of a request is read 
+ *  directly into the buffer and only its unaligned head and tail go through 
+ *  small aligned bounce buffers, otherwise the whole request does. If the 
+ *  file system does not support O_DIRECT the file is opened normally.
+ *
+ *  The io_uring is set up at the first wait() and used for all further 
+ *  ones of the same reader.
+ */
+class BinaryReader {
+
+private:
+  /*! One contiguous read, large requests are split into several chunks */
+  struct Chunk {
+    char* buf;
+    size_t len;
+    size_t offset;
+    size_t done;
+    size_t min_len; /*!< bytes which must be read, less than len at EOF */
+  };
+  /*! Copy from a bounce buffer to the destination after the read */
+  struct CopyBack {
+    char* bounce;
+    size_t skip;
+    char* dest;
+    size_t len;
+  };
+  /*! Mapped io_uring, defined in the source file */
+  struct Ring;
+
+  std::string filename;
+  std::string backend;
+  bool direct;
+  int fd;
+  size_t file_size;
+  std::vector<Chunk> chunks;
+  std::vector<CopyBack> copy_backs;
+  std::unique_ptr<Ring> ring;
+
+  void add_chunks(char* buf, const size_t len, const size_t offset,
+                  const size_t min_len);
+  void add_bounced(char* dest, const size_t nbytes, const size_t offset);
+  void read_pread();
+  bool read_io_uring();
+
+public:
+  /*! Opens the file for reading
+   *
+   *  @param filename  Name of the file
+   *  @param io_params io_backend and io_direct decide how the file is read
+   */
+  BinaryReader(const std::string& filename, const IOParameters& io_params);
+
+  /*! Closes the file and the ring and releases all bounce buffers */
+  ~BinaryReader();
+
+  BinaryReader(const BinaryReader&) = delete;
+  BinaryReader& operator=(const BinaryReader&) = delete;
+
+  /*! Queues a read of nbytes at offset into dest, nothing is read yet */
+  void queue(void* dest, const size_t nbytes, const size_t offset);
+
+  /*! Issues all queued reads and returns when all of them are finished.
+   *  Stops the program if the file is too short or a read fails.
+   */
+  void wait();
+
+  /*! Size of the file in bytes */
+  inline size_t size() const {
+    return file_size;
+  }
+  /*! Backend which is actually used */
+  inline const std::string& get_backend() const {
+    return backend;
+  }
+
+};
+
+} // end of namespace
+
+#endif // _BINARY_READER_H_
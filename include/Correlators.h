@@ -251,9 +251,16 @@ public:
   // Standard Destructor
   ~Correlators () {};
 
+  /*! Operators read by the diagrams of contract() in the order they are
+   *  computed, see OperatorsForMesons::plan_operator_lifetimes()
+   */
+  std::vector<OperatorUsage> operator_usage(
+                                     const OperatorLookup& operator_lookup,
+                                     const CorrelatorLookup& corr_lookup, 
+                                     const QuarklineLookup& quark_lookup) const;
   /*! Call all functions building a correlator */
   void contract(Quarklines& quarklines, 
-                const OperatorsForMesons& meson_operator,
+                OperatorsForMesons& meson_operator,
                 const Perambulator& perambulators,
                 const OperatorLookup& operator_lookup,
                 const CorrelatorLookup& corr_lookup, 
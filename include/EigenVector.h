@@ -7,6 +7,7 @@
 
 #include <Eigen/Dense> 
 
+#include "global_data_typedefs.h"
 #include "typedefs.h"
 
 namespace LapH {
@@ -18,6 +19,9 @@ class EigenVector {
 private:
   vec_Xcd_eigen V;
 
+  // prints trace and sum of V^dagger V for timeslice t as a small check
+  void print_check(const size_t t) const;
+
 public:
   // standard ctor that does nothing
   EigenVector() : V(0, Eigen::MatrixXcd(0, 0)){};
@@ -52,6 +56,21 @@ public:
   //        verbose  -> if 1 additional information will be written out
   void read_eigen_vector(const std::string& filename, const size_t t, 
                          const size_t verbose);
+  // mapping the eigen vector file for a specific timeslice into memory and 
+  // copying it into V[t] via an Eigen::Map
+  // input: same as above
+  void read_eigen_vector_mmap(const std::string& filename, const size_t t, 
+                              const size_t verbose);
+  // reading the eigen vector from some file for a specific timeslice. With
+  // handling_eigenvectors = mmap read_eigen_vector_mmap() is used. Otherwise,
+  // unless io_backend is stdio, all columns are queued at once in a 
+  // BinaryReader and read directly into V[t]
+  // input: filename  -> the path with the FULL filename
+  //        t         -> timeslice in V where the eigenvector will be written to
+  //        verbose   -> if 1 additional information will be written out
+  //        io_params -> backend and O_DIRECT flag for reading
+  void read_eigen_vector(const std::string& filename, const size_t t, 
+                         const size_t verbose, const IOParameters& io_params);
 
 };
 // -----------------------------------------------------------------------------
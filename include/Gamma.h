@@ -0,0 +1,119 @@
+/*! @file Gamma.h
+ *  Compile-time tables of the 16 Dirac structures and the complex phases
+ *  they consist of
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _GAMMA_H_
+#define _GAMMA_H_
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+
+#include "typedefs.h"
+
+namespace LapH {
+
+/*! Runtime form of a Dirac structure: row r has the non-zero entry value[r]
+ *  in column row[r]
+ */
+struct gamma_lookup {
+  std::array<int, 4> row;
+  std::array<cmplx, 4> value;
+};
+
+/*! @{
+ *  Every Dirac structure (0-15) is a permutation of the four Dirac indices
+ *  times a phase per row. The phase p stands for @f$ i^p @f$, i.e. 0, 1, 2,
+ *  3 for 1, i, -1, -i. The structures are
+ *  - 0-3:   @f$ \gamma_0, \ldots, \gamma_3 @f$
+ *  - 4:     unity
+ *  - 5:     @f$ \gamma_5 @f$
+ *  - 6-9:   @f$ \gamma_\mu \gamma_5 @f$
+ *  - 10-12: @f$ \gamma_0 \gamma_i @f$
+ *  - 13-15: @f$ \gamma_0 \gamma_i \gamma_5 @f$
+ */
+constexpr int gamma_row[16][4] = {
+  {2, 3, 0, 1}, {3, 2, 1, 0}, {3, 2, 1, 0}, {2, 3, 0, 1},
+  {0, 1, 2, 3}, {0, 1, 2, 3},
+  {2, 3, 0, 1}, {3, 2, 1, 0}, {3, 2, 1, 0}, {2, 3, 0, 1},
+  {1, 0, 3, 2}, {1, 0, 3, 2}, {0, 1, 2, 3},
+  {1, 0, 3, 2}, {1, 0, 3, 2}, {0, 1, 2, 3}};
+constexpr int gamma_phase[16][4] = {
+  {0, 0, 0, 0}, {3, 3, 1, 1}, {2, 0, 0, 2}, {3, 1, 1, 3},
+  {0, 0, 0, 0}, {0, 0, 2, 2},
+  {2, 2, 0, 0}, {1, 1, 1, 1}, {0, 2, 0, 2}, {1, 3, 1, 3},
+  {1, 1, 3, 3}, {0, 2, 2, 0}, {1, 3, 3, 1},
+  {1, 1, 1, 1}, {0, 2, 0, 2}, {1, 3, 1, 3}};
+/*! @} */
+
+/*! Multiplication with @f$ i^P @f$ as sign flips and swaps of real and
+ *  imaginary part, to be used with Eigen's unaryExpr()
+ *
+ *  The packet versions keep the expressions vectorised.
+ */
+template <int P> struct Phase;
+template <> struct Phase<0> {
+  inline cmplx operator()(const cmplx& x) const { return x; }
+  template <typename Packet> 
+  inline Packet packetOp(const Packet& x) const { return x; }
+};
+template <> struct Phase<1> {
+  inline cmplx operator()(const cmplx& x) const {
+    return cmplx(-x.imag(), x.real());
+  }
+  template <typename Packet> 
+  inline Packet packetOp(const Packet& x) const {
+    return Eigen::internal::pcplxflip(Eigen::internal::pconj(x));
+  }
+};
+template <> struct Phase<2> {
+  inline cmplx operator()(const cmplx& x) const { return -x; }
+  template <typename Packet> 
+  inline Packet packetOp(const Packet& x) const {
+    return Eigen::internal::pnegate(x);
+  }
+};
+template <> struct Phase<3> {
+  inline cmplx operator()(const cmplx& x) const {
+    return cmplx(x.imag(), -x.real());
+  }
+  template <typename Packet> 
+  inline Packet packetOp(const Packet& x) const {
+    return Eigen::internal::pconj(Eigen::internal::pcplxflip(x));
+  }
+};
+
+/*! Runtime form of the Dirac structure gamma_id, used where the phase is
+ *  only needed as a number, e.g. for the traces in the correlators
+ */
+inline gamma_lookup create_gamma(const int gamma_id){
+  if(gamma_id < 0 || gamma_id > 15){
+    printf("Dirac component %d not found in create_gamma\n", gamma_id);
+    exit(0);
+  }
+  const cmplx phase[4] = {cmplx(1., 0.), cmplx(0., 1.), cmplx(-1., 0.),
+                          cmplx(0., -1.)};
+  gamma_lookup gamma;
+  for(size_t r = 0; r < 4; r++){
+    gamma.row[r] = gamma_row[gamma_id][r];
+    gamma.value[r] = phase[gamma_phase[gamma_id][r]];
+  }
+  return gamma;
+}
+
+} // end of namespace
+
+namespace Eigen {
+namespace internal {
+template <int P> struct functor_traits<LapH::Phase<P> > {
+  enum { Cost = NumTraits<cmplx>::AddCost, 
+         PacketAccess = packet_traits<cmplx>::Vectorizable };
+};
+} // end of namespace internal
+} // end of namespace Eigen
+
+#endif // _GAMMA_H_
@@ -0,0 +1,84 @@
+/*! @file GaugeField.h
+ *  Class decleration of LapH::GaugeField
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _GAUGE_FIELD_H_
+#define _GAUGE_FIELD_H_
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "Eigen/StdVector"
+
+#include "typedefs.h"
+
+namespace LapH {
+
+/*! Spatial links of one timeslice of a gauge configuration and the covariant
+ *  derivative of eigenvectors
+ *
+ *  The configurations are read in the ILDG format, i.e. the record
+ *  "ildg-binary-data" of a LIME file holding big endian 3x3 matrices in row
+ *  major order for the directions x, y, z, t on every site, with x running
+ *  fastest and t slowest. Single and double precision are told apart by the
+ *  length of the record.
+ *
+ *  Internally the sites are ordered as the rows of the eigenvectors,
+ *  site = x*Ly*Lz + y*Lz + z.
+ */
+class GaugeField {
+
+private:
+  const size_t Lt, Lx, Ly, Lz, volume;
+  /*! Link in direction dir on site at index 3*site + dir */
+  std::vector<Eigen::Matrix3cd, Eigen::aligned_allocator<Eigen::Matrix3cd> >
+                                                                         links;
+
+  /*! Site index of the neighbour of site in direction dir (0, 1, 2 for x,
+   *  y, z) with periodic boundary conditions, step is +1 or -1
+   */
+  size_t neighbour(const size_t site, const size_t dir, const int step) const;
+
+public:
+  /*! Allocates the links of one timeslice */
+  GaugeField(const size_t Lt, const size_t Lx, const size_t Ly,
+             const size_t Lz);
+  ~GaugeField() {};
+
+  /*! Reads the spatial links of timeslice t
+   *
+   *  @param filename Name of the configuration including its number
+   *  @param t        Timeslice
+   */
+  void read_timeslice(const std::string& filename, const size_t t);
+
+  /*! Adds factor times the symmetric covariant derivative in direction dir
+   *  to W
+   *
+   *  @param[in]     dir    0, 1, 2 for x, y, z
+   *  @param[in]     factor Prefactor of the derivative
+   *  @param[in]     V      Eigenvectors of the timeslice, 3*volume x nb_ev
+   *  @param[in,out] W      Same size as V, gets
+   *                        @f$ W(x) += f [U_d(x) V(x+d) -
+   *                                       U^\dagger_d(x-d) V(x-d)] @f$
+   */
+  void add_derivative(const size_t dir, const double factor,
+                      const Eigen::MatrixXcd& V, Eigen::MatrixXcd& W) const;
+
+  /*! Link in direction dir on site */
+  inline const Eigen::Matrix3cd& operator()(const size_t site,
+                                            const size_t dir) const {
+    return links[3*site + dir];
+  }
+
+};
+
+} // end of namespace
+
+#endif // _GAUGE_FIELD_H_
@@ -65,18 +65,23 @@ private:
   std::string path_eigenvectors;
   std::string name_eigenvectors;
   std::string filename_eigenvectors;
+  std::string filename_config;
   std::string path_perambulators;
   std::string name_perambulators;
   std::string name_lattice;
   std::string path_output;
   std::string overwrite;
   std::string path_config;
+  std::string name_config;
   std::string handling_vdaggerv;
   std::string path_vdaggerv;
+  std::string vdaggerv_engine;
+  std::string handling_rvdaggervr;
   //! @endcond
 
   RandomVectorConstruction rnd_vec_construct;
   PerambulatorConstruction peram_construct;
+  IOParameters io_params;
  
   std::vector<quark> quarks;
   std::vector<Operator_list> operator_list;
@@ -177,6 +182,10 @@ public:
   inline PerambulatorConstruction get_peram_construct() {
     return peram_construct;
   }
+  /*! Returns all information how input files are read from disk */
+  inline IOParameters get_io_params() {
+    return io_params;
+  }
   inline std::string get_path_eigenvectors() {
     return path_eigenvectors;
   }
@@ -186,6 +195,10 @@ public:
   inline std::string get_filename_eigenvectors () {
     return filename_eigenvectors;
   }
+  /*! Return the gauge configuration, only needed for displaced operators */
+  inline std::string get_filename_config () {
+    return filename_config;
+  }
   inline std::string get_path_perambulators() {
     return path_perambulators;
   }
@@ -202,6 +215,18 @@ public:
   inline std::string get_path_vdaggerv() {
     return path_vdaggerv;
   }
+  /*! Return how VdaggerV is computed from the eigenvectors: direct, fft, 
+   *  auto or benchmark
+   */
+  inline std::string get_vdaggerv_engine() {
+    return vdaggerv_engine;
+  }
+  /*! Return whether rVdaggerVr is stored for all timeslices or built per 
+   *  block of timeslices inside the diagrams: store or stream
+   */
+  inline std::string get_handling_rvdaggervr() {
+    return handling_rvdaggervr;
+  }
 
   /*! Return munged list of quarks as specified in the infile
    * 
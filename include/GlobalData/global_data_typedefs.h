@@ -37,6 +37,57 @@ struct PerambulatorConstruction {
 
 };
 
+/*! Small struct which contains all information how the input files are read
+ *  from disk.
+ *
+ *  @see LapH::Perambulator::read_perambulators_from_separate_files()
+ *  @see LapH::BinaryReader
+ */
+struct IOParameters {
+
+  /*! read: fread into a temporary buffer and reorder serially
+   *  mmap: map the file and reorder in parallel straight into the matrices
+   *  stream: read slabs of at most perambulator_buffer_size and reorder them
+   */
+  std::string handling_perambulators;
+  /*! read: the eigenvectors are read in place into the matrices
+   *  mmap: the files are mapped and copied via Eigen::Map
+   */
+  std::string handling_eigenvectors;
+  /*! double or single: precision in which the perambulators are stored in
+   *  memory
+   */
+  std::string perambulator_precision;
+  /*! double or single: precision of the perambulator files */
+  std::string perambulator_file_precision;
+  /*! Memory budget for the slab buffer of the stream mode in MB */
+  size_t perambulator_buffer_size;
+  /*! Number of perambulator or random vector files read concurrently. Also
+   *  the number of reading threads in the VdaggerV pipeline
+   */
+  size_t nb_io_threads;
+  /*! Number of eigenvector timeslices buffered between reading and computing
+   *  in OperatorsForMesons::build_vdaggerv, 0 switches the pipeline off
+   */
+  size_t vdaggerv_queue_depth;
+  /*! stdio: fread/ifstream as before
+   *  pread, io_uring: reads are queued and issued via LapH::BinaryReader
+   */
+  std::string io_backend;
+  /*! Bypass the page cache with O_DIRECT, only for pread and io_uring */
+  bool io_direct;
+  /*! eager: VdaggerV is read completely into memory
+   *  lazy:  VdaggerV files are only mapped, timeslices are paged in when
+   *         they are used
+   */
+  std::string vdaggerv_access;
+  /*! Read the perambulators and random vectors of the next configuration in
+   *  the background while the current one is contracted
+   */
+  bool prefetch_config;
+
+};
+
 /*! Quark type that contains all quark propagator informations: 
  *
  *  Flavor, number of random vectors, dilution scheme, path and a unique id. 
@@ -0,0 +1,57 @@
+/*! @file MappedFile.h
+ *  Class decleration of LapH::MappedFile
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace LapH {
+
+/*! Read-only memory mapping of a whole file
+ *
+ *  The mapping is created in the constructor and released in the destructor,
+ *  thus the data pointer is valid for the lifetime of the object only.
+ */
+class MappedFile {
+
+private:
+  void* addr;
+  size_t length;
+
+public:
+  /*! Maps the file read-only into memory
+   *
+   *  @param filename Name of the file which is mapped
+   */
+  MappedFile(const std::string& filename);
+
+  /*! Unmaps the file */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /*! Passes an access pattern hint (e.g. MADV_SEQUENTIAL) to the kernel */
+  void advise(const int advice) const;
+
+  /*! Size of the mapped file in bytes */
+  inline size_t size() const {
+    return length;
+  }
+  /*! Pointer to the first byte of the mapped file */
+  inline const char* data() const {
+    return static_cast<const char*>(addr);
+  }
+
+};
+
+} // end of namespace
+
+#endif // _MAPPED_FILE_H_
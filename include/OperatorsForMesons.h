@@ -9,21 +9,38 @@
 #define OPERATORSFORMESONS_H_
 
 #include <algorithm>
+#include <array>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "boost/multi_array.hpp"
 #include "boost/filesystem.hpp"
 #include "Eigen/Dense"
 
 #include "EigenVector.h"
+#include "MappedFile.h"
 #include "RandomVector.h"
+#include "VdaggerVContainer.h"
+#include "global_data_typedefs.h"
 #include "typedefs.h"
 
 namespace LapH {
 
+/*! Operators of each kind which one stage of a configuration reads, the 
+ *  entries are the indices passed to return_vdaggerv(), return_rvdaggerv() 
+ *  and return_rvdaggervr()
+ */
+struct OperatorUsage {
+  std::string stage;
+  std::vector<size_t> vdaggerv, rvdaggerv, rvdaggervr;
+};
+
 /*! Calculates operators as they emerge in correlation functions using the 
  *  stochastic estimates from the stochastic Laplacian Heaviside method
  *
@@ -32,10 +49,8 @@ namespace LapH {
  *  - rVdaggerV   : @f$ (P^(b)\rho V)^\dagger exp(ipx) V @f$
  *  - rVdaggerVr  : @f$ (P^(b)\rho V)^\dagger exp(ipx) (P^(b)\rho V) @f$
  *
- *  It is straightforward to generalize the operators for Displacement, but 
- *  not implemented
- *
- *  @TODO Implement derivate operators
+ *  For displaced operators the right V is replaced by its covariant 
+ *  derivative @f$ \sum_i d_i \nabla_i V @f$, see LapH::GaugeField
  */
 class OperatorsForMesons {
 
@@ -48,9 +63,28 @@ private:
   /*! @cond
    *  internal indices etc.
    */
-  array_cd_d2 momentum;
+  std::array<array_cd_d2, 3> momentum;
   /*! @endcond */
+
+  /*! @{
+   *  vdaggerv_access = lazy: pointers to VdaggerV in the mapped files, 
+   *  index id*Lt + t, and the mappings they point into
+   */
+  std::vector<const cmplx*> vdaggerv_views;
+  std::vector<std::unique_ptr<MappedFile> > vdaggerv_mappings;
+  std::unique_ptr<VdaggerVContainer> vdaggerv_container;
+  Eigen::MatrixXcd unity;
+  /*! @} */
   
+  /****************************************************************************/
+  /*! @{
+   *  Index of the last stage in plan_operator_lifetimes() which reads an 
+   *  operator, -1 if none does
+   */
+  std::vector<std::string> stages;
+  std::vector<int> last_use_vdaggerv, last_use_rvdaggerv, last_use_rvdaggervr;
+  /*! @} */
+
   /****************************************************************************/
   /*! @TODO comment private members */
   const OperatorLookup operator_lookuptable;
@@ -59,12 +93,26 @@ private:
   bool is_vdaggerv_set = false;
   std::string handling_vdaggerv;
   std::string path_vdaggerv;
+  std::string vdaggerv_engine;
+  std::string handling_rvdaggervr;
+  const IOParameters io_params;
+  /*! Random vectors of the last create_operators(), read by 
+   *  build_rvdaggervr_one_t()
+   */
+  const LapH::RandomVector* rnd_vec = nullptr;
 
   // Internal functions to build individual operators --> The interface to these
   // functions is 'create_Operators'
   // input -> filename: name and path of eigenvectors
-  void build_vdaggerv(const std::string& filename, const int config);
+  //          filename_gauge: name and path of the gauge configuration
+  void build_vdaggerv(const std::string& filename, 
+                      const std::string& filename_gauge, const int config);
+  void build_vdaggerv_pipelined(const std::string& filename, 
+            const size_t dim_row,
+            const std::function<void(const size_t, 
+                                     const Eigen::MatrixXcd&)>& compute);
   void read_vdaggerv(const int config);
+  void read_vdaggerv_container(const int config);
   void read_vdaggerv_liuming(const int config);
   void build_rvdaggerv(const LapH::RandomVector& rnd_vec);
   void build_rvdaggervr(const LapH::RandomVector& rnd_vec);
@@ -75,7 +123,10 @@ public:
                      const size_t Lz, const size_t nb_ev, const size_t dilE,
                      const OperatorLookup& operator_lookuptable,
                      const std::string& handling_vdaggerv,
-                     const std::string& path_vdaggerv);
+                     const std::string& path_vdaggerv,
+                     const std::string& vdaggerv_engine,
+                     const std::string& handling_rvdaggervr,
+                     const IOParameters& io_params);
   /*! Standard Destructor
    *
    *  Everything should be handled by Eigen, std::vector, and boost::multi_array
@@ -89,15 +140,47 @@ public:
    *  calculates rvdaggerv and rvdaggervr
    */
   void create_operators(const std::string& filename,
+                        const std::string& filename_gauge,
                         const LapH::RandomVector& rnd_vec, const int config);
+  /*! Starts reading the input files of create_operators() for config into
+   *  the page cache. Only a hint, create_operators() reads the files itself
+   */
+  void prefetch_input(const std::string& filename, 
+                      const std::string& filename_gauge, 
+                      const int config) const;
   /*! Free memory of vdaggerv */
   void free_memory_vdaggerv();
   /*! Free memory of rvdaggerv */
   void free_memory_rvdaggerv();
 
-  inline const Eigen::MatrixXcd& return_vdaggerv(const size_t index,
-                                                 const size_t t) const {
-    return vdaggerv[index][t];
+  /*! Sets the stages which read operators after create_operators(), in the 
+   *  order they are executed for each configuration
+   */
+  void plan_operator_lifetimes(const std::vector<OperatorUsage>& usage);
+  /*! Frees all operators which are not read after stage and prints the 
+   *  memory of the operators before and after
+   */
+  void release_operators(const std::string& stage);
+  /*! Memory of vdaggerv, rvdaggerv and rvdaggervr in bytes */
+  size_t memory_usage() const;
+
+  /*! VdaggerV of operator index on timeslice t. With vdaggerv_access = lazy
+   *  this is a view into the mapped file and the page cache holds the data
+   */
+  inline Eigen::Map<const Eigen::MatrixXcd> return_vdaggerv(const size_t index,
+                                                        const size_t t) const {
+    if(!vdaggerv_views.empty())
+      return Eigen::Map<const Eigen::MatrixXcd>(vdaggerv_views[index*Lt + t],
+                                                nb_ev, nb_ev);
+    return Eigen::Map<const Eigen::MatrixXcd>(vdaggerv[index][t].data(),
+                        vdaggerv[index][t].rows(), vdaggerv[index][t].cols());
+  }
+
+  /*! True if VdaggerV of operator index is the unit matrix, i.e. zero 
+   *  momentum and displacement. Users can then skip the multiplication.
+   */
+  inline bool is_vdaggerv_unity(const size_t index) const {
+    return int(index) == operator_lookuptable.index_of_unity;
   }
 
   inline const Eigen::MatrixXcd& return_rvdaggerv(const size_t index, 
@@ -112,6 +195,52 @@ public:
     return rvdaggervr.at(index).at(t).at(rnd_id);
   }
 
+  /*! True if rVdaggerVr is not stored and has to be built with 
+   *  build_rvdaggervr_one_t(), i.e. handling_rvdaggervr = stream
+   */
+  inline bool is_rvdaggervr_streamed() const {
+    return handling_rvdaggervr == "stream";
+  }
+  /*! Builds rVdaggerVr of operator index on timeslice t for all random 
+   *  vector combinations from VdaggerV and the random vectors of the last
+   *  create_operators()
+   */
+  void build_rvdaggervr_one_t(const size_t index, const size_t t,
+                              std::vector<Eigen::MatrixXcd>& rvdvr) const;
+
+};
+
+/*! Thread local access to rVdaggerVr for the correlator loops
+ *
+ *  With handling_rvdaggervr = store this only forwards to 
+ *  OperatorsForMesons::return_rvdaggervr(). With stream rVdaggerVr of an 
+ *  operator and timeslice is built when it is read for the first time and 
+ *  kept as long as the timeslice is in one of the two dilution blocks set 
+ *  with set_blocks(). Thus it is reused for all t1 of a block pair and the 
+ *  full array over Lt is never stored.
+ */
+class RVdaggerVRBuffer {
+
+private:
+  const OperatorsForMesons& meson_operator;
+  /*! Number of timeslices per dilution block */
+  const size_t dilT;
+  std::map<std::pair<size_t, size_t>, std::vector<Eigen::MatrixXcd> > 
+                                                                    rvdaggervr;
+
+public:
+  RVdaggerVRBuffer(const OperatorsForMesons& meson_operator, 
+                   const size_t dilT) : meson_operator(meson_operator), 
+                                        dilT(dilT), rvdaggervr() {};
+  ~RVdaggerVRBuffer() {};
+
+  /*! Frees all timeslices which are not in the blocks t1_i and t2_i */
+  void set_blocks(const size_t t1_i, const size_t t2_i);
+
+  /*! Same as OperatorsForMesons::return_rvdaggervr() */
+  const Eigen::MatrixXcd& return_rvdaggervr(const size_t index, 
+                                            const size_t t, 
+                                            const size_t rnd_id);
 };
 
 } // end of namespace
@@ -12,6 +12,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include "Eigen/Dense"
@@ -21,11 +22,27 @@
 
 namespace LapH {
 
-/*! Memory allocation and reading routines for perambulators */
+/*! View onto a block of a perambulator in double precision */
+typedef Eigen::Map<const Eigen::MatrixXcd, 0, Eigen::OuterStride<> > 
+                                                              PerambulatorBlock;
+
+/*! Memory allocation and reading routines for perambulators 
+ *
+ *  The perambulators are stored either in double or in single precision. In 
+ *  single precision only half of the memory is needed, block() converts the
+ *  requested part back to double precision, thus all products and sums are 
+ *  still done in double precision.
+ */
 class Perambulator {
 
 private:
   std::vector<Eigen::MatrixXcd> peram;
+  /*! Used instead of peram if stored in single precision */
+  std::vector<Eigen::MatrixXcf> peram_sp;
+
+  void reorder(const char* src, const size_t row_begin, const size_t row_end,
+               const size_t nb_eigen_vec, const quark& quark, 
+               const size_t entity, const bool single_file);
 
 public:  
 
@@ -37,30 +54,91 @@ public:
    *  @param nb_entitites Number of perambulators
    *  @param size_rows    Number of rows for each perambulator
    *  @param size_cols    Number of columns for each perambulator
+   *  @param single_precision Store the perambulators in single precision
    */
   Perambulator(const size_t nb_entities, 
                const std::vector<size_t>& size_rows, 
-               const std::vector<size_t>& size_cols):
-                                    peram(nb_entities, Eigen::MatrixXcd(0, 0)) {
+               const std::vector<size_t>& size_cols,
+               const bool single_precision = false) {
     // TODO: Think about putting this in initialisation list (via lambda?)
-    for(size_t i = 0; i < nb_entities; i++)
-      peram[i].resize(size_rows[i], size_cols[i]);
-
-    std::cout << "\tPerambulators initialised" << std::endl;
+    if(single_precision){
+      peram_sp.resize(nb_entities);
+      for(size_t i = 0; i < nb_entities; i++)
+        peram_sp[i].resize(size_rows[i], size_cols[i]);
+    }
+    else{
+      peram.resize(nb_entities);
+      for(size_t i = 0; i < nb_entities; i++)
+        peram[i].resize(size_rows[i], size_cols[i]);
+    }
+
+    std::cout << "\tPerambulators initialised" 
+              << (single_precision ? " in single precision" : "") << std::endl;
   }
 
   /*! Default deconstructor - std::vector and Eigen should handle everything */
   ~Perambulator() {};
 
-  /*! Overloading [] operator for Perambulator objects */
+  /*! Overloading [] operator for Perambulator objects, only for double 
+   *  precision storage
+   */
   inline const Eigen::MatrixXcd& operator[](const size_t entity) const {
     return peram.at(entity);
   }
 
+  /*! Block of perambulator entity in double precision
+   *
+   *  @param buffer Holds the converted block for single precision storage. 
+   *                The view is valid as long as buffer is not changed.
+   *
+   *  In double precision this is a view without copy.
+   */
+  inline PerambulatorBlock block(const size_t entity, const size_t row, 
+                                 const size_t col, const size_t nb_rows,
+                                 const size_t nb_cols,
+                                 Eigen::MatrixXcd& buffer) const {
+    if(peram_sp.empty()){
+      const Eigen::MatrixXcd& p = peram[entity];
+      return PerambulatorBlock(p.data() + col*p.rows() + row, nb_rows, nb_cols,
+                               Eigen::OuterStride<>(p.rows()));
+    }
+    buffer = peram_sp[entity].block(row, col, nb_rows, nb_cols).cast<cmplx>();
+    return PerambulatorBlock(buffer.data(), nb_rows, nb_cols,
+                             Eigen::OuterStride<>(nb_rows));
+  }
+
+  inline bool is_single_precision() const {
+    return !peram_sp.empty();
+  }
+  inline size_t rows(const size_t entity) const {
+    return peram_sp.empty() ? peram[entity].rows() : peram_sp[entity].rows();
+  }
+  inline size_t cols(const size_t entity) const {
+    return peram_sp.empty() ? peram[entity].cols() : peram_sp[entity].cols();
+  }
+
   /*! Reading one perambulators from a single file */
   void read_perambulator(const size_t entity, const size_t Lt, 
                          const size_t nb_eigen_vec, const quark& quark,
-                         const std::string& filename);
+                         const std::string& filename,
+                         const IOParameters& io_params);
+
+  /*! Reading one perambulator from a single file via mmap and reordering 
+   *  it in parallel without an intermediate buffer
+   */
+  void read_perambulator_mmap(const size_t entity, const size_t Lt, 
+                              const size_t nb_eigen_vec, const quark& quark,
+                              const std::string& filename,
+                              const bool single_file);
+
+  /*! Reading one perambulator from a single file in slabs which are 
+   *  reordered one after another to bound the extra memory
+   */
+  void read_perambulator_streaming(const size_t entity, const size_t Lt, 
+                                   const size_t nb_eigen_vec, 
+                                   const quark& quark,
+                                   const std::string& filename,
+                                   const IOParameters& io_params);
 
   /*! Reading perambulators where each perambulator is stored in a different 
    *  file 
@@ -68,7 +146,8 @@ public:
   void read_perambulators_from_separate_files(
                                  const size_t Lt, const size_t nb_eigen_vec,
                                  const std::vector<quark>& quark,
-                                 const std::vector<std::string>& filename_list);
+                                 const std::vector<std::string>& filename_list,
+                                 const IOParameters& io_params);
 
 };
 
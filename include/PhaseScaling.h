@@ -0,0 +1,48 @@
+/*! @file PhaseScaling.h
+ *  Declaration of the SIMD kernels which multiply eigenvectors with
+ *  momentum phases
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _PHASE_SCALING_H_
+#define _PHASE_SCALING_H_
+
+#include <cstdlib>
+
+#include "typedefs.h"
+
+namespace LapH {
+
+/*! Computes W = diag(phase) V for a column major block of rows of V, where
+ *  the three colour rows of a lattice site share one phase
+ *
+ *  @param[in]  V        First element of the block
+ *  @param[in]  ld_V     Leading dimension of V
+ *  @param[in]  phase    One phase per lattice site
+ *  @param[in]  nb_sites Number of lattice sites of the block, it has
+ *                       3*nb_sites rows
+ *  @param[in]  nb_cols  Number of columns of the block
+ *  @param[out] W        First element of the result
+ *  @param[in]  ld_W     Leading dimension of W
+ *
+ *  The phases of a group of sites are expanded to the rows in registers once
+ *  and applied to all columns, thus no row-wise copy of the phases is
+ *  stored. Every complex product is one fused multiply-add/subtract of V and
+ *  its real/imaginary swapped copy. The AVX-512 or AVX2 version is chosen at
+ *  the first call according to the features of the CPU, independent of the
+ *  flags the code was compiled with, otherwise a plain loop is used.
+ */
+void scale_by_phase(const cmplx* V, const size_t ld_V, const cmplx* phase,
+                    const size_t nb_sites, const size_t nb_cols, cmplx* W,
+                    const size_t ld_W);
+
+/*! Name of the instruction set used by scale_by_phase(): "avx512", "avx2"
+ *  or "generic"
+ */
+const char* phase_scaling_isa();
+
+} // end of namespace
+
+#endif // _PHASE_SCALING_H_
@@ -2,23 +2,109 @@
 #define OUARKLINES_H_
 
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
+#include <tuple>
 
 #include "boost/multi_array.hpp"
 #include "Eigen/Dense"
 
+#include "Gamma.h"
 #include "OperatorsForMesons.h"
 #include "Perambulator.h"
 #include "typedefs.h"
 
 namespace LapH {
 
-struct gamma_lookup {
-  std::array<int, 4> row;
-  std::array<cmplx, 4> value;
+/*! Gamma-free products of the four Dirac blocks L_r of a left factor with 
+ *  the four Dirac row blocks P_s of the perambulator
+ *
+ *  A gamma structure only permutes and rescales the Dirac blocks, see 
+ *  Gamma.h. Block (r, s) = L_r * P_s is thus built once for all quarklines
+ *  which only differ in gamma, and every gamma is a view on the blocks 
+ *  (r, gamma_row[r]) times the phase gamma_phase[r]. Only the blocks of the 
+ *  requested gamma structures are built.
+ *
+ *  The perambulators of several second random vectors are put side by side, 
+ *  every block holds the products for all of them.
+ */
+class QuarklineCore {
+
+private:
+  const size_t dilE, nev;
+  /*! Blocks (r, s) needed by the requested gamma structures */
+  std::array<std::array<bool, 4>, 4> needed;
+  /*! P_s of all random vectors side by side, nev x nb_rnd*4*dilE */
+  std::array<Eigen::MatrixXcd, 4> panel;
+  /*! L_r * P_s */
+  std::array<std::array<Eigen::MatrixXcd, 4>, 4> core;
+  /*! holds the perambulator blocks for single precision storage */
+  Eigen::MatrixXcd buffer;
+
+  /*! @{
+   *  Quarkline of the Dirac structure G for the random vector rnd, counted
+   *  from first. The permutation and the phases are resolved at compile 
+   *  time.
+   */
+  template <int G> 
+  void gamma_Q1(const size_t rnd, Eigen::MatrixXcd& Q1) const;
+  template <int G> 
+  void gamma_Q2(const size_t rnd, Eigen::MatrixXcd& Q2) const;
+  /*! @} */
+
+public:
+  QuarklineCore(const size_t dilE, const size_t nev);
+  ~QuarklineCore() {};
+
+  /*! Forgets all requested gamma structures */
+  void clear();
+  /*! Marks the blocks (r, gamma_row[gamma_id][r]) as needed */
+  void request(const size_t gamma_id);
+  /*! Puts the perambulators of the second random vectors of 
+   *  rnd_vec_ids[first, last) side by side
+   *
+   *  @param t           Timeslice of the rows, P_s starts at row (4*t + s)*nev
+   *  @param block_peram Time block of the columns
+   */
+  void set_perambulator(const Perambulator& peram, const size_t t, 
+                const size_t block_peram,
+                const std::vector<std::pair<size_t, size_t> >& rnd_vec_ids,
+                const size_t first, const size_t last);
+  /*! Builds the needed blocks (r, s) from L_r and the perambulators */
+  void multiply(const size_t r, 
+                const Eigen::Ref<const Eigen::MatrixXcd>& L_r);
+  /*! Block (r, s) of the random vector rnd, counted from first */
+  inline Eigen::Block<const Eigen::MatrixXcd> view(const size_t r, 
+                                                   const size_t s,
+                                                   const size_t rnd) const {
+    return core[r][s].block(0, rnd*4*dilE, core[r][s].rows(), 4*dilE);
+  }
+  /*! Q1 of the Dirac structure gamma_id for the random vector rnd, row block
+   *  r is the phase times block (r, gamma_row[r])
+   */
+  void view_Q1(const size_t gamma_id, const size_t rnd, 
+               Eigen::MatrixXcd& Q1) const;
+  /*! Q2 of the Dirac structure gamma_id for the random vector rnd, the sum 
+   *  over r of the phase times block (r, gamma_row[r])
+   */
+  void view_Q2(const size_t gamma_id, const size_t rnd, 
+               Eigen::MatrixXcd& Q2) const;
+
+  /*! Q1 of all entries in ql_lookup on timeslice t with the perambulator 
+   *  columns of time block block_peram, stored in Q1[i1][i2]
+   *
+   *  Entries which only differ in gamma share one core.
+   */
+  void build_Q1(const Perambulator& peram,
+                const OperatorsForMesons& meson_operator,
+                const size_t t, const size_t block_peram,
+                const std::vector<QuarklineQ1Indices>& ql_lookup,
+                const std::vector<RandomIndexCombinationsQ2>& ric_lookup,
+                array_quarkline& Q1, const size_t i1, const size_t i2);
 };
 
 class Quarklines {
@@ -87,6 +173,42 @@ private:
   array_quarkline Q2L;
   const size_t Lt, dilT, dilE, nev;
   std::vector<LapH::gamma_lookup>  gamma;
+  /*! Gamma-free products shared by the quarklines which differ in gamma */
+  QuarklineCore core;
+
+  /*! Cache for the left factor M of Q2, the key is (t1, block_M, rnd, 
+   *  id_vdaggerv, need_vdaggerv_dag). M does not depend on gamma, thus it is
+   *  shared by all Q2V and Q2L entries with the same VdaggerV.
+   */
+  std::map<std::tuple<size_t, size_t, size_t, size_t, bool>, Eigen::MatrixXcd>
+                                                                      M_cache;
+  size_t M_cache_hits, M_cache_misses;
+
+  /*! Builds the left factor M of Q2 for the first random vector rnd, with the
+   *  perambulator columns of time block block_M
+   */
+  void build_M(const Perambulator& peram,
+               const OperatorsForMesons& meson_operator,
+               const size_t t1, const size_t block_M,
+               const QuarklineQ2Indices& qll, const size_t rnd,
+               Eigen::MatrixXcd& M, Eigen::MatrixXcd& buffer) const;
+  /*! M from the cache, it is built with build_M() if it is not there yet */
+  const Eigen::MatrixXcd& return_M(const Perambulator& peram,
+                                   const OperatorsForMesons& meson_operator,
+                                   const size_t t1, const size_t block_M,
+                                   const QuarklineQ2Indices& qll, 
+                                   const size_t rnd, Eigen::MatrixXcd& buffer);
+  /*! Q2V and Q2L of all operators in ql_lookup for t1 at position pos 
+   *
+   *  The cached M of t1 are freed afterwards unless keep_M is set.
+   */
+  void build_Q2_one_t(const Perambulator& peram,
+                      const OperatorsForMesons& meson_operator,
+                      const size_t t1, const size_t block_M,
+                      const size_t block_peram, const size_t pos,
+                      const std::vector<QuarklineQ2Indices>& ql_lookup,
+                      const std::vector<RandomIndexCombinationsQ2>& ric_lookup,
+                      array_quarkline& Q2, const bool keep_M);
 
 public:
 
@@ -115,6 +237,13 @@ public:
                                    const size_t op_id, const size_t rnd) const {
     return Q2L[t1][t2][op_id].at(rnd);
   }
+  /*! Number of times M of Q2 was taken from the cache and was built */
+  inline size_t return_M_cache_hits() const {
+    return M_cache_hits;
+  }
+  inline size_t return_M_cache_misses() const {
+    return M_cache_misses;
+  }
 
   // ----------------- INTERFACE FOR BUILDING QUARKLINES -----------------------
   // ---------------------------------------------------------------------------
@@ -10,6 +10,7 @@
 
 #include <complex>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -93,9 +94,11 @@ public:
   /*! Read random vectors where each vector is stored in a different file
    *
    *  @param filename_list Vector which contains all file names
+   *  @param nb_io_threads Number of files which are read concurrently
    */
   void read_random_vectors_from_separate_files(
-                                 const std::vector<std::string>& filename_list);
+                                 const std::vector<std::string>& filename_list,
+                                 const size_t nb_io_threads = 1);
 
 };
 
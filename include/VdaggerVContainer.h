@@ -0,0 +1,128 @@
+/*! @file VdaggerVContainer.h
+ *  Class decleration of LapH::VdaggerVContainer
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#ifndef _VDAGGERV_CONTAINER_H_
+#define _VDAGGERV_CONTAINER_H_
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Eigen/Dense"
+
+#include "MappedFile.h"
+#include "typedefs.h"
+
+namespace LapH {
+
+/*! Single file holding VdaggerV for all operators and timeslices of one
+ *  configuration
+ *
+ *  Layout of the file:
+ *  - magic "LAPHVDV1", nb_ev, Lt and the number of operators nb_op as
+ *    uint64_t
+ *  - for every operator momentum and displacement as 6 int32_t
+ *  - nb_op x Lt byte offsets as uint64_t, index op*Lt + t
+ *  - the matrices in column major order, each starting at a multiple of 4096
+ *    bytes
+ *
+ *  A single matrix is thus obtained by one positioned read or by a view onto
+ *  the mapped file.
+ */
+class VdaggerVContainer {
+
+private:
+  std::string filename;
+  int fd;
+  size_t nb_ev, Lt;
+  std::vector<std::array<int, 6> > keys;
+  std::vector<uint64_t> offsets;
+  std::unique_ptr<MappedFile> mapping;
+
+  VdaggerVContainer(const std::string& filename) : filename(filename),
+                                                   fd(-1), nb_ev(0), Lt(0) {};
+
+public:
+  /*! Creates the file for writing and writes the header
+   *
+   *  @param filename     Name of the file, an existing file is overwritten
+   *  @param nb_ev        Number of eigenvectors
+   *  @param Lt           Number of timeslices
+   *  @param vdaggerv_ops Operators which are stored, their position in this
+   *                      vector is the index used in write()
+   */
+  static std::unique_ptr<VdaggerVContainer> create(const std::string& filename,
+              const size_t nb_ev, const size_t Lt,
+              const std::vector<VdaggerVQuantumNumbers>& vdaggerv_ops);
+
+  /*! Opens an existing file for reading
+   *
+   *  @param filename Name of the file
+   *  @param map      If true, the file is mapped and view() can be used
+   */
+  static std::unique_ptr<VdaggerVContainer> open(const std::string& filename,
+                                                 const bool map);
+
+  /*! Closes the file */
+  ~VdaggerVContainer();
+
+  VdaggerVContainer(const VdaggerVContainer&) = delete;
+  VdaggerVContainer& operator=(const VdaggerVContainer&) = delete;
+
+  /*! Index of the operator with momentum and displacement, -1 if the file
+   *  does not contain it
+   */
+  int find(const std::array<int, 3>& momentum,
+           const std::array<int, 3>& displacement) const;
+
+  /*! Writes VdaggerV of operator index on timeslice t, thread safe */
+  void write(const size_t index, const size_t t, const Eigen::MatrixXcd& vdv);
+
+  /*! Reads VdaggerV of operator index on timeslice t with one positioned
+   *  read, thread safe
+   */
+  void read(const size_t index, const size_t t, Eigen::MatrixXcd& vdv) const;
+
+  /*! View onto VdaggerV of operator index on timeslice t in the mapped file.
+   *  Only valid if the file was opened with map = true.
+   */
+  inline Eigen::Map<const Eigen::MatrixXcd> view(const size_t index,
+                                                 const size_t t) const {
+    return Eigen::Map<const Eigen::MatrixXcd>(reinterpret_cast<const cmplx*>(
+                        mapping->data() + offsets[index*Lt + t]), nb_ev, nb_ev);
+  }
+
+  /*! Position of VdaggerV of operator index on timeslice t in bytes */
+  inline uint64_t offset(const size_t index, const size_t t) const {
+    return offsets[index*Lt + t];
+  }
+  /*! Size of one VdaggerV matrix in bytes */
+  inline size_t matrix_size() const {
+    return nb_ev*nb_ev*sizeof(cmplx);
+  }
+  /*! The mapping of the file, NULL if the file is not mapped */
+  inline const MappedFile* get_mapping() const {
+    return mapping.get();
+  }
+  inline const std::string& get_filename() const {
+    return filename;
+  }
+  inline size_t get_nb_ev() const {
+    return nb_ev;
+  }
+  inline size_t get_Lt() const {
+    return Lt;
+  }
+
+};
+
+} // end of namespace
+
+#endif // _VDAGGERV_CONTAINER_H_
@@ -23,6 +23,7 @@
 
 /*! @{ Abbreviation for complex data types */
 typedef std::complex<double> cmplx;
+typedef std::complex<float> cmplxf;
 typedef std::vector<cmplx> vec;
 /*! @} */
 
@@ -67,8 +68,9 @@ typedef boost::multi_array<Eigen::MatrixXcd, 10> array_Xcd_d10_eigen;
  *
  *  In contrast to the field operator the Dirac structure is factored out
  *
- *  @todo check the expression for displacement
- *  @deprecated only displacement 0 is implement atm (26.3.17)
+ *  A non-zero displacement d stands for the derivative operator 
+ *  @f$ V^\dagger exp(ipx) \sum_i d_i \nabla_i V @f$ with the symmetric 
+ *  covariant derivative, e.g. d = (0,0,1) is one derivative in z direction
  */
 struct VdaggerVQuantumNumbers{ 
   size_t id;
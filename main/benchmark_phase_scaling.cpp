@@ -0,0 +1,90 @@
+/*! @file benchmark_phase_scaling.cpp
+ *  Micro benchmark of the phase scaling in the direct VdaggerV engine
+ *
+ *  Built with -DBUILD_BENCHMARKS=ON. For one row block of the eigenvectors
+ *  the scaling with the site phases is done with Eigen's diagonal product
+ *  and with LapH::scale_by_phase(), alone and together with the following
+ *  product @f$ V^\dagger W @f$. The GFLOP/s of both and their relative
+ *  deviation are printed. Build it with and without -march=native to see
+ *  the effect of the runtime dispatch.
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "omp.h"
+
+#include "PhaseScaling.h"
+#include "typedefs.h"
+
+namespace {
+
+/*! Same block size as in vdaggerv_all_momenta() */
+const size_t block_bytes = 512 << 10;
+
+/******************************************************************************/
+void benchmark(const size_t nb_ev) {
+
+  const size_t nb_rows = block_bytes / (2 * nb_ev * sizeof(cmplx)) / 3 * 3;
+  const size_t nb_sites = nb_rows / 3;
+  const Eigen::MatrixXcd V = Eigen::MatrixXcd::Random(nb_rows, nb_ev);
+  const Eigen::VectorXcd site_phase = Eigen::VectorXcd::Random(nb_sites);
+  Eigen::VectorXcd phase(nb_rows);
+  for(size_t s = 0; s < nb_sites; s++)
+    phase.segment(3*s, 3).setConstant(site_phase(s));
+  Eigen::MatrixXcd W_eigen(nb_rows, nb_ev), W_kernel(nb_rows, nb_ev);
+  Eigen::MatrixXcd vdv(nb_ev, nb_ev);
+  const size_t reps = 200;
+
+  // 0, 1: scaling alone, 2, 3: scaling and product
+  double time[4];
+  // the first pass warms up caches and allocations and is not counted
+  for(size_t pass = 0; pass < 2; pass++){
+    for(size_t version = 0; version < 4; version++){
+      const double start = omp_get_wtime();
+      for(size_t r = 0; r < reps; r++){
+        if(version % 2 == 0)
+          W_eigen.noalias() = phase.asDiagonal() * V;
+        else
+          LapH::scale_by_phase(V.data(), V.rows(), site_phase.data(),
+                               nb_sites, nb_ev, W_kernel.data(),
+                               W_kernel.rows());
+        if(version >= 2)
+          vdv.noalias() += V.adjoint() *
+                           (version == 2 ? W_eigen : W_kernel);
+      }
+      time[version] = omp_get_wtime() - start;
+    }
+  }
+
+  const double flops_scaling = 6. * nb_rows * nb_ev * reps;
+  const double flops_product = 8. * nb_rows * nb_ev * nb_ev * reps;
+  std::cout << "\tnb_ev = " << nb_ev << ", " << nb_rows << " rows:\n\t\t"
+            << std::fixed << std::setprecision(1) << "scaling: Eigen "
+            << flops_scaling / time[0] * 1e-9 << " GFLOP/s, kernel "
+            << flops_scaling / time[1] * 1e-9 << " GFLOP/s\n\t\t"
+            << "scaling and product: Eigen "
+            << (flops_scaling + flops_product) / time[2] * 1e-9
+            << " GFLOP/s, kernel "
+            << (flops_scaling + flops_product) / time[3] * 1e-9
+            << " GFLOP/s\n\t\tdeviation " << std::scientific
+            << std::setprecision(1)
+            << (W_eigen - W_kernel).norm() / W_eigen.norm() << std::endl;
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+int main() {
+
+  std::cout << "Phase scaling benchmark with " << LapH::phase_scaling_isa()
+            << " kernel and " << omp_get_max_threads() << " OpenMP threads"
+            << std::endl;
+  for(const size_t nb_ev : {32, 64, 120, 240})
+    benchmark(nb_ev);
+  return 0;
+}
@@ -0,0 +1,162 @@
+/*! @file benchmark_quarklines.cpp
+ *  Micro benchmark of the products building the quarklines
+ *
+ *  Built with -DBUILD_BENCHMARKS=ON. The old and the current formulation of
+ *  each product are run on random matrices of the shapes used in
+ *  LapH::Quarklines and the GFLOP/s of both and their relative deviation
+ *  are printed. Run it with OMP_NUM_THREADS=1 to get single core numbers.
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "omp.h"
+
+#include "Gamma.h"
+#include "typedefs.h"
+
+namespace {
+
+/*! Number of timeslices of the random perambulator */
+const size_t Lt = 8;
+
+/******************************************************************************/
+/*! Q1 = gamma rVdaggerV P for one pair of timeslices: 16 products of dilE x
+ *  dilE blocks against one product per Dirac row block
+ */
+void benchmark_Q1(const size_t nev, const size_t dilE) {
+
+  const LapH::gamma_lookup gamma = LapH::create_gamma(5);
+  const Eigen::MatrixXcd peram = Eigen::MatrixXcd::Random(4*nev*Lt,
+                                                          4*dilE*Lt);
+  const Eigen::MatrixXcd rvdaggerv = Eigen::MatrixXcd::Random(4*dilE, nev);
+  Eigen::MatrixXcd Q1_blocks = Eigen::MatrixXcd::Zero(4*dilE, 4*dilE);
+  Eigen::MatrixXcd Q1_rows = Q1_blocks;
+  const size_t reps = 2400000 / nev;
+
+  auto blocks = [&](const size_t t1, const size_t t2) {
+    for(size_t row = 0; row < 4; row++)
+      for(size_t col = 0; col < 4; col++)
+        Q1_blocks.block(row*dilE, col*dilE, dilE, dilE) = gamma.value[row] *
+                rvdaggerv.block(row*dilE, 0, dilE, nev) *
+                peram.block((t1*4 + gamma.row[row])*nev, (t2*4 + col)*dilE,
+                            nev, dilE);
+  };
+  auto rows = [&](const size_t t1, const size_t t2) {
+    for(size_t row = 0; row < 4; row++)
+      Q1_rows.middleRows(row*dilE, dilE).noalias() = gamma.value[row] *
+                rvdaggerv.middleRows(row*dilE, dilE) *
+                peram.block((t1*4 + gamma.row[row])*nev, t2*4*dilE,
+                            nev, 4*dilE);
+  };
+
+  const double flops = 8. * 16 * dilE * dilE * nev * reps;
+  double time[2];
+  // the first pass warms up caches and allocations and is not counted
+  for(size_t pass = 0; pass < 2; pass++){
+    for(size_t version = 0; version < 2; version++){
+      const double start = omp_get_wtime();
+      for(size_t r = 0; r < reps; r++){
+        if(version == 0)
+          blocks(r % Lt, (r / Lt) % Lt);
+        else
+          rows(r % Lt, (r / Lt) % Lt);
+      }
+      time[version] = omp_get_wtime() - start;
+    }
+  }
+  std::cout << "\tQ1 nev = " << nev << ", dilE = " << dilE << ":\t"
+            << std::fixed << std::setprecision(1)
+            << flops / time[0] * 1e-9 << " GFLOP/s with 16 blocks, "
+            << flops / time[1] * 1e-9 << " GFLOP/s with 4 row blocks, "
+            << "deviation " << std::scientific << std::setprecision(1)
+            << (Q1_blocks - Q1_rows).norm() / Q1_rows.norm() << std::endl;
+}
+
+/******************************************************************************/
+/*! Q2 = M gamma P for all random vector partners of one M: 64 products of 
+ *  dilE x dilE blocks per partner against one product with the gamma 
+ *  permuted perambulators of all partners side by side
+ */
+void benchmark_Q2(const size_t nev, const size_t dilE) {
+
+  const LapH::gamma_lookup gamma = LapH::create_gamma(5);
+  // six random vectors, the five others are partners of the first one
+  const size_t nb_partners = 5;
+  const std::vector<Eigen::MatrixXcd> peram(nb_partners, 
+                                  Eigen::MatrixXcd::Random(4*nev, 4*dilE));
+  const Eigen::MatrixXcd M = Eigen::MatrixXcd::Random(4*dilE, 4*nev);
+  std::vector<Eigen::MatrixXcd> Q2_blocks(nb_partners);
+  std::vector<Eigen::MatrixXcd> Q2_wide(nb_partners);
+  Eigen::MatrixXcd panel(4*nev, nb_partners*4*dilE);
+  Eigen::MatrixXcd product(4*dilE, nb_partners*4*dilE);
+  const size_t reps = 48000 / nev;
+
+  auto blocks = [&]() {
+    for(size_t p = 0; p < nb_partners; p++){
+      Q2_blocks[p].setZero(4*dilE, 4*dilE);
+      for(size_t b = 0; b < 4; b++)
+        for(size_t row = 0; row < 4; row++)
+          for(size_t col = 0; col < 4; col++)
+            Q2_blocks[p].block(row*dilE, col*dilE, dilE, dilE) += 
+                gamma.value[b] * M.block(row*dilE, b*nev, dilE, nev) *
+                peram[p].block(gamma.row[b]*nev, col*dilE, nev, dilE);
+    }
+  };
+  auto wide = [&]() {
+    for(size_t p = 0; p < nb_partners; p++)
+      for(size_t b = 0; b < 4; b++)
+        panel.block(b*nev, p*4*dilE, nev, 4*dilE) = gamma.value[b] * 
+                peram[p].middleRows(gamma.row[b]*nev, nev);
+    product.noalias() = M * panel;
+    for(size_t p = 0; p < nb_partners; p++)
+      Q2_wide[p] = product.middleCols(p*4*dilE, 4*dilE);
+  };
+
+  const double flops = 8. * nb_partners * 16 * dilE * dilE * 4 * nev * reps;
+  double time[2];
+  // the first pass warms up caches and allocations and is not counted
+  for(size_t pass = 0; pass < 2; pass++){
+    for(size_t version = 0; version < 2; version++){
+      const double start = omp_get_wtime();
+      for(size_t r = 0; r < reps; r++){
+        if(version == 0)
+          blocks();
+        else
+          wide();
+      }
+      time[version] = omp_get_wtime() - start;
+    }
+  }
+  double deviation = 0.;
+  for(size_t p = 0; p < nb_partners; p++)
+    deviation = std::max(deviation, 
+                 (Q2_blocks[p] - Q2_wide[p]).norm() / Q2_wide[p].norm());
+  std::cout << "\tQ2 nev = " << nev << ", dilE = " << dilE << ":\t"
+            << std::fixed << std::setprecision(1)
+            << flops / time[0] * 1e-9 << " GFLOP/s with blocks, "
+            << flops / time[1] * 1e-9 << " GFLOP/s with one wide product, "
+            << "deviation " << std::scientific << std::setprecision(1)
+            << deviation << std::endl;
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+int main() {
+
+  Eigen::initParallel();
+  std::cout << "Quarkline benchmark with " << omp_get_max_threads()
+            << " OpenMP threads" << std::endl;
+  for(const size_t nev : {120, 240})
+    for(const size_t dilE : {4, 6})
+      benchmark_Q1(nev, dilE);
+  for(const size_t nev : {120, 240})
+    for(const size_t dilE : {4, 6})
+      benchmark_Q2(nev, dilE);
+  return 0;
+}
@@ -11,13 +11,34 @@
  *  @copyright Copies are prohibited so far
  */ 
 
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <thread>
 
 #include "omp.h"
 
 #include "Correlators.h" // contains all other headers
 #include "global_data.h"
 
+namespace {
+
+/*! Returns the memory available for new allocations according to the kernel 
+ *  (MemAvailable in /proc/meminfo) in bytes, 0 if it cannot be determined
+ */
+size_t available_memory() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  size_t value;
+  std::string unit;
+  while(meminfo >> key >> value >> unit)
+    if(key == "MemAvailable:")
+      return value * 1024;
+  return 0;
+}
+
+} // end of unnamed namespace
+
 
 /*! Read parameters from infile and perform the specified contractions
  *
@@ -27,6 +48,13 @@
  *  - Get paths, physical quantum numbers and desired operators from infile 
  *  - Loop over Configuration
  *  - Read perambulators, randomvectors and contract
+ *  - With prefetch_config the perambulators and randomvectors of the next 
+ *    configuration are read in a background thread into a second set while 
+ *    the current one is contracted. The eigenvectors, gauge configuration 
+ *    or VdaggerV files of the next configuration only get a readahead hint
+ *    into the page cache, create_operators() still reads them after the 
+ *    contraction. They are not double buffered since the eigenvectors alone
+ *    are Lt x 3V x nev and often larger than everything else together.
  *
  *  The flow of this function is depicted in the Flowchart below. The colors
  *  uniquely encode the class a member function belongs to. Beige fields are 
@@ -44,16 +72,45 @@ int main (int ac, char* av[]) {
   omp_set_num_threads(global_data->get_nb_omp_threads());
   Eigen::setNbThreads(global_data->get_nb_eigen_threads());
 
+  // ---------------------------------------------------------------------------
+  // Size of one set of perambulators and random vectors. With prefetch_config
+  // a second set is allocated after the first configuration is set up if it
+  // fits into memory, and the next configuration is read in the background 
+  // while the current one is contracted.
+  const PerambulatorConstruction peram_construct = 
+                                             global_data->get_peram_construct();
+  const RandomVectorConstruction rnd_vec_construct = 
+                                           global_data->get_rnd_vec_construct();
+  const std::string peram_precision = 
+                          global_data->get_io_params().perambulator_precision;
+  if(peram_precision != "double" && peram_precision != "single"){
+    std::cout << "\n\tThe flag perambulator_precision in input file is "
+              << "wrong!!\n\n" << std::endl;
+    exit(0);
+  }
+  const bool single_precision = peram_precision == "single";
+  size_t bytes_per_config = rnd_vec_construct.nb_entities * 
+                            rnd_vec_construct.length * sizeof(cmplx);
+  for(size_t i = 0; i < peram_construct.nb_entities; i++)
+    bytes_per_config += peram_construct.size_rows[i] * 
+                        peram_construct.size_cols[i] * 
+                        (single_precision ? sizeof(cmplxf) : sizeof(cmplx));
+  bool prefetch = global_data->get_io_params().prefetch_config;
+
   // ---------------------------------------------------------------------------
   // Creating instances of perambulators, random vectors, operators, and 
   // correlators. The eigenvectors are read from disc in the operator class.
-  LapH::Perambulator perambulators(
-                                 global_data->get_peram_construct().nb_entities,
-                                 global_data->get_peram_construct().size_rows,
-                                 global_data->get_peram_construct().size_cols);
-  LapH::RandomVector randomvectors(
-                               global_data->get_rnd_vec_construct().nb_entities,
-                               global_data->get_rnd_vec_construct().length);
+  // The vectors are never reallocated, the background reader keeps indexing
+  // into them.
+  std::vector<LapH::Perambulator> perambulators;
+  std::vector<LapH::RandomVector> randomvectors;
+  perambulators.reserve(2);
+  randomvectors.reserve(2);
+  perambulators.emplace_back(peram_construct.nb_entities,
+                             peram_construct.size_rows,
+                             peram_construct.size_cols, single_precision);
+  randomvectors.emplace_back(rnd_vec_construct.nb_entities,
+                             rnd_vec_construct.length);
 
   LapH::OperatorsForMesons meson_operators(
                             global_data->get_Lt(), global_data->get_Lx(),
@@ -62,7 +119,10 @@ int main (int ac, char* av[]) {
                             (global_data->get_quarks())[0].number_of_dilution_E,
                             global_data->get_operator_lookuptable(),
                             global_data->get_handling_vdaggerv(),
-                            global_data->get_path_vdaggerv());  
+                            global_data->get_path_vdaggerv(),
+                            global_data->get_vdaggerv_engine(),
+                            global_data->get_handling_rvdaggervr(),
+                            global_data->get_io_params());
   /*! @todo Quarklines Can be deleted after memory optimizing all diagrams */
   LapH::Quarklines quarklines(global_data->get_Lt(), 
                          (global_data->get_quarks())[0].number_of_dilution_T,
@@ -77,6 +137,45 @@ int main (int ac, char* av[]) {
                           global_data->get_number_of_eigen_vec(),
                           global_data->get_correlator_lookuptable());
 
+  // Q1 is built for all entries of its lookup table before the diagrams, 
+  // afterwards each operator is freed after the last diagram reading it
+  {
+    std::vector<LapH::OperatorUsage> usage(1);
+    usage[0].stage = "quarklines";
+    for(const auto& q : global_data->get_quarkline_lookuptable().Q1)
+      usage[0].rvdaggerv.push_back(q.id_rvdaggerv);
+    const auto diagrams = correlators.operator_usage(
+                                    global_data->get_operator_lookuptable(),
+                                    global_data->get_correlator_lookuptable(),
+                                    global_data->get_quarkline_lookuptable());
+    usage.insert(usage.end(), diagrams.begin(), diagrams.end());
+    meson_operators.plan_operator_lifetimes(usage);
+  }
+
+  // reads perambulators and random vectors with the file names currently set
+  // in global_data into buffer. The file names are copied, thus global_data 
+  // may change while this runs in the background. In the background the 
+  // OpenMP regions of the reading routines run next to the ones of the 
+  // contraction and are limited to nb_io_threads threads. The number of 
+  // threads is a per-thread setting and does not affect the contraction.
+  auto read_inputs = [&](const size_t buffer,
+                         const std::vector<std::string> peram_files,
+                         const std::vector<std::string> rnd_vec_files,
+                         const bool background) {
+    if(background)
+      omp_set_num_threads(global_data->get_io_params().nb_io_threads);
+    perambulators[buffer].read_perambulators_from_separate_files(
+                              global_data->get_Lt(),
+                              global_data->get_number_of_eigen_vec(),
+                              global_data->get_quarks(), peram_files,
+                              global_data->get_io_params());
+    randomvectors[buffer].read_random_vectors_from_separate_files(
+                              rnd_vec_files,
+                              global_data->get_io_params().nb_io_threads);
+  };
+  std::thread loader;
+  size_t buffer = 0;
+
   // ---------------------------------------------------------------------------
   // Loop over all configurations stated in the infile -------------------------
   for(size_t config_i  = global_data->get_start_config(); 
@@ -85,37 +184,78 @@ int main (int ac, char* av[]) {
 
     std::cout << "\nprocessing configuration: " << config_i 
               << "\n\n" << std::endl;
-    // changes all paths and names which depend on the configuration
-    global_data->build_IO_names(config_i);
-
-    // read perambulators
-    perambulators.read_perambulators_from_separate_files(
-                              global_data->get_Lt(),
-                              global_data->get_number_of_eigen_vec(),
-                              global_data->get_quarks(),
-                              global_data->get_peram_construct().filename_list);
-    // read random vectors
-    randomvectors.read_random_vectors_from_separate_files(
-                            global_data->get_rnd_vec_construct().filename_list);
+    if(loader.joinable()){
+      // the inputs were read in the background, the file names are already
+      // set to this configuration
+      loader.join();
+      buffer = 1 - buffer;
+    }
+    else{
+      // changes all paths and names which depend on the configuration
+      global_data->build_IO_names(config_i);
+      // read perambulators and random vectors
+      read_inputs(buffer, global_data->get_peram_construct().filename_list,
+                  global_data->get_rnd_vec_construct().filename_list, false);
+    }
     // read eigenvectors and build operators
     meson_operators.create_operators(global_data->get_filename_eigenvectors(),
-                                                       randomvectors, config_i);
+                                     global_data->get_filename_config(),
+                                     randomvectors[buffer], config_i);
     /*! Building quarklines from operators and perambulators
      *  @todo Can be deleted after all correlators are memory optimized 
      */
-    quarklines.create_quarklines(perambulators, meson_operators, 
+    quarklines.create_quarklines(perambulators[buffer], meson_operators, 
                           global_data->get_quarkline_lookuptable(),
                           global_data->get_operator_lookuptable().ricQ2_lookup);
-    // this memory is not needed anymore
-//    meson_operators.free_memory_rvdaggerv();
-//    meson_operators.free_memory_vdaggerv();
+    // operators which are not needed by the diagrams are freed
+    meson_operators.release_operators("quarklines");
+
+    // starting to read the next configuration in the background
+    const size_t next_config = config_i + global_data->get_delta_config();
+    if(prefetch && perambulators.size() == 1 && 
+       next_config <= global_data->get_end_config()){
+      // The first set, the operators and the quarklines are resident at this
+      // point and no longer part of MemAvailable. The contraction allocates
+      // further buffers of the order of the operators, a quarter of the 
+      // resident data is kept free for them. The readahead of the 
+      // eigenvectors and VdaggerV only fills the page cache, which the kernel
+      // can reclaim, and is therefore not counted.
+      const size_t needed = bytes_per_config + 
+                       (bytes_per_config + meson_operators.memory_usage()) / 4;
+      if(needed > available_memory()){
+        std::cout << "\tNot enough memory for a second set of perambulators "
+                  << "and random vectors (" << needed / 1048576 << " MB)"
+                  << " - configurations are processed serially" << std::endl;
+        prefetch = false;
+      }
+      else{
+        perambulators.emplace_back(peram_construct.nb_entities,
+                                   peram_construct.size_rows,
+                                   peram_construct.size_cols, 
+                                   single_precision);
+        randomvectors.emplace_back(rnd_vec_construct.nb_entities,
+                                   rnd_vec_construct.length);
+      }
+    }
+    if(prefetch && next_config <= global_data->get_end_config()){
+      global_data->build_IO_names(next_config);
+      meson_operators.prefetch_input(global_data->get_filename_eigenvectors(),
+                                     global_data->get_filename_config(),
+                                     next_config);
+      loader = std::thread(read_inputs, 1 - buffer, 
+                           global_data->get_peram_construct().filename_list,
+                           global_data->get_rnd_vec_construct().filename_list,
+                           true);
+    }
 
     // doing all the contractions
-    correlators.contract(quarklines, meson_operators, perambulators,
+    correlators.contract(quarklines, meson_operators, perambulators[buffer],
                          global_data->get_operator_lookuptable(),
                          global_data->get_correlator_lookuptable(),
                          global_data->get_quarkline_lookuptable());
   }
+  if(loader.joinable())
+    loader.join();
   // That's all Folks!
   return 0;
 }
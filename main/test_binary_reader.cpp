@@ -0,0 +1,202 @@
+/*! @file test_binary_reader.cpp
+ *  Test of LapH::BinaryReader against a file with known content
+ *
+ *  Built with -DBUILD_TESTS=ON and run by ctest. A random file whose size is
+ *  no multiple of the O_DIRECT alignment and which is larger than one chunk
+ *  is read with the pread and the io_uring backend, with and without
+ *  O_DIRECT. The requests have aligned and unaligned offsets and lengths,
+ *  destinations which are misaligned like the offset or not, and reach up
+ *  to the end of the file. A reader is used for several wait() calls.
+ *  Finally the io_uring backend is run in a child process in which
+ *  io_uring_setup fails, where it has to fall back to pread.
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#endif
+
+#include "BinaryReader.h"
+
+namespace {
+
+const std::string filename = "test_binary_reader.bin";
+// more than one chunk of 64 MB and no multiple of the alignment
+const size_t file_size = (64 << 20) + 3*LapH::direct_alignment + 1234;
+
+std::mt19937_64 generator(42);
+
+/******************************************************************************/
+/*! One read request, dest is shift bytes into an aligned buffer */
+struct Request {
+  size_t offset;
+  size_t nbytes;
+  size_t shift;
+};
+
+/******************************************************************************/
+std::vector<Request> random_requests(){
+  const size_t align = LapH::direct_alignment;
+  std::vector<Request> requests;
+  // whole file, split into chunks
+  requests.push_back({0, file_size, 0});
+  // end of the file, aligned and unaligned
+  requests.push_back({file_size - 5000, 5000, (file_size - 5000) % align});
+  requests.push_back({file_size - 1, 1, 17});
+  // less than one block inside a single block and across two blocks
+  requests.push_back({align + 10, 100, 10});
+  requests.push_back({2*align - 50, 100, 3});
+  for(size_t i = 0; i < 200; i++){
+    size_t offset = generator() % file_size;
+    if(i % 3 == 0)
+      offset -= offset % align;
+    size_t nbytes = 1 + generator() % std::min(file_size - offset,
+                                               size_t(300000));
+    if(i % 5 == 0)
+      nbytes = std::max(align, nbytes - nbytes % align);
+    nbytes = std::min(nbytes, file_size - offset);
+    // same misalignment as the offset or an arbitrary one
+    const size_t shift = i % 2 ? offset % align : generator() % align;
+    requests.push_back({offset, nbytes, shift});
+  }
+  return requests;
+}
+
+/******************************************************************************/
+/*! Reads the requests in several rounds with one reader
+ *
+ *  @return Number of requests which differ from the file
+ */
+size_t read_requests(const std::vector<char>& content,
+                     const std::string& backend, const bool direct,
+                     std::string& backend_used){
+  IOParameters io_params;
+  io_params.io_backend = backend;
+  io_params.io_direct = direct;
+  LapH::BinaryReader reader(filename, io_params);
+  if(reader.size() != file_size)
+    return 1;
+
+  size_t failures = 0;
+  for(size_t round = 0; round < 3; round++){
+    const std::vector<Request> requests = random_requests();
+    std::vector<LapH::DirectBuffer> buffers;
+    for(const auto& r : requests)
+      buffers.emplace_back(r.nbytes + r.shift);
+    for(size_t i = 0; i < requests.size(); i++)
+      reader.queue(&buffers[i][requests[i].shift], requests[i].nbytes,
+                   requests[i].offset);
+    reader.wait();
+    for(size_t i = 0; i < requests.size(); i++)
+      if(memcmp(&buffers[i][requests[i].shift],
+                &content[requests[i].offset], requests[i].nbytes))
+        failures++;
+  }
+  backend_used = reader.get_backend();
+  return failures;
+}
+
+/******************************************************************************/
+/*! Runs the io_uring backend in a child process where io_uring_setup fails
+ *  with ENOSYS, as on kernels without io_uring
+ *
+ *  @return Number of failures, 0 if the check is not possible here
+ */
+size_t test_fallback(const std::vector<char>& content){
+#if defined(__linux__) && defined(__NR_io_uring_setup) && \
+    defined(SECCOMP_MODE_FILTER)
+  std::cout.flush();
+  const pid_t pid = fork();
+  if(pid == 0){
+    sock_filter filter[] = {
+      BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_setup, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS),
+      BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW)};
+    sock_fprog program = {sizeof(filter) / sizeof(filter[0]), filter};
+    if(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 ||
+       prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) != 0)
+      _exit(2);
+    std::string backend_used;
+    const size_t failures = read_requests(content, "io_uring", true,
+                                          backend_used);
+    _exit(failures == 0 && backend_used == "pread" ? 0 : 1);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if(WIFEXITED(status) && WEXITSTATUS(status) == 2){
+    std::cout << "\tseccomp is not available, fallback not checked"
+              << std::endl;
+    return 0;
+  }
+  const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  std::cout << "\tio_uring unavailable: " << (ok ? "ok" : "FAILED")
+            << std::endl;
+  return ok ? 0 : 1;
+#else
+  return 0;
+#endif
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+int main() {
+
+  std::vector<char> content(file_size);
+  for(auto& c : content)
+    c = char(generator());
+  {
+    std::ofstream file(filename, std::ofstream::binary);
+    file.write(content.data(), content.size());
+  }
+
+  // the reader silently drops O_DIRECT where the file system lacks it
+  const int fd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+  if(fd == -1)
+    std::cout << "\tO_DIRECT is not supported in the working directory, "
+              << "the direct reads use the page cache" << std::endl;
+  else
+    close(fd);
+
+  size_t failures = 0;
+  for(const std::string backend : {"pread", "io_uring"})
+    for(const bool direct : {false, true}){
+      std::string backend_used;
+      const size_t f = read_requests(content, backend, direct, backend_used);
+      std::cout << "\t" << backend << (direct ? " with" : " without")
+                << " O_DIRECT (" << backend_used << " used): "
+                << (f ? "FAILED" : "ok") << std::endl;
+      failures += f;
+    }
+  failures += test_fallback(content);
+  std::remove(filename.c_str());
+
+  if(failures){
+    std::cout << "\n" << failures << " checks of LapH::BinaryReader failed\n"
+              << std::endl;
+    return 1;
+  }
+  std::cout << "\nAll checks of LapH::BinaryReader passed\n" << std::endl;
+  return 0;
+}
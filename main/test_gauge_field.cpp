@@ -0,0 +1,271 @@
+/*! @file test_gauge_field.cpp
+ *  Test of the reading of gauge configurations and of the covariant
+ *  derivative in LapH::GaugeField
+ *
+ *  Built with -DBUILD_TESTS=ON and run by ctest. A random configuration of
+ *  unitary links on an asymmetric lattice is written as LIME file in single
+ *  and double precision. For every timeslice the links read back are
+ *  compared with the written ones, which checks the ILDG site and direction
+ *  order, add_derivative() is compared with the stencil written out in
+ *  coordinates, which checks the periodic neighbours, and
+ *  @f$ V^\dagger D V @f$ is checked to be invariant under a random gauge
+ *  transformation.
+ *
+ *  @author Bastian Knippschild
+ *  @author Markus Werner
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "GaugeField.h"
+#include "typedefs.h"
+
+namespace {
+
+// all extents differ to catch mixed up coordinates
+const size_t Lt = 3, Lx = 4, Ly = 3, Lz = 5;
+const size_t volume = Lx*Ly*Lz;
+const size_t nb_ev = 4;
+
+typedef std::vector<Eigen::Matrix3cd,
+                    Eigen::aligned_allocator<Eigen::Matrix3cd> > LinkVector;
+
+std::mt19937 generator(42);
+
+/******************************************************************************/
+/*! Index of a link in the configurations of this test */
+inline size_t link_index(const size_t t, const size_t x, const size_t y,
+                         const size_t z, const size_t dir){
+  return (((t*Lx + x)*Ly + y)*Lz + z)*4 + dir;
+}
+
+/******************************************************************************/
+/*! Index of a site as in the rows of the eigenvectors */
+inline size_t site_index(const size_t x, const size_t y, const size_t z){
+  return (x*Ly + y)*Lz + z;
+}
+
+/******************************************************************************/
+Eigen::Matrix3cd random_unitary(){
+  std::normal_distribution<double> normal;
+  Eigen::Matrix3cd m;
+  for(size_t a = 0; a < 3; a++)
+    for(size_t b = 0; b < 3; b++)
+      m(a, b) = cmplx(normal(generator), normal(generator));
+  return Eigen::Matrix3cd(m.householderQr().householderQ());
+}
+
+/******************************************************************************/
+/*! Converts to big endian in place */
+template <typename T>
+void to_big_endian(T& value){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  char* bytes = reinterpret_cast<char*>(&value);
+  std::reverse(bytes, bytes + sizeof(T));
+#endif
+}
+
+/******************************************************************************/
+/*! Writes one LIME record, the data is padded to a multiple of 8 bytes */
+void write_lime_record(std::ofstream& file, const std::string& type,
+                       const std::vector<char>& data){
+  char header[144] = {};
+  uint32_t magic = 0x456789ab;
+  uint16_t version = 1;
+  uint64_t length = data.size();
+  to_big_endian(magic);
+  to_big_endian(version);
+  to_big_endian(length);
+  memcpy(header, &magic, 4);
+  memcpy(header + 4, &version, 2);
+  memcpy(header + 8, &length, 8);
+  strncpy(header + 16, type.c_str(), 127);
+  file.write(header, 144);
+  file.write(data.data(), data.size());
+  const std::vector<char> padding((8 - data.size() % 8) % 8, 0);
+  file.write(padding.data(), padding.size());
+}
+
+/******************************************************************************/
+/*! Writes the links in the ILDG format with x running fastest and t
+ *  slowest, preceded by a record of odd length to check the skipping
+ */
+template <typename T>
+void write_configuration(const std::string& filename, const LinkVector& U){
+  std::vector<char> data;
+  data.reserve(Lt*volume*4*9*2*sizeof(T));
+  for(size_t t = 0; t < Lt; t++)
+  for(size_t z = 0; z < Lz; z++)
+  for(size_t y = 0; y < Ly; y++)
+  for(size_t x = 0; x < Lx; x++)
+    for(size_t dir = 0; dir < 4; dir++)
+      for(size_t a = 0; a < 3; a++)
+        for(size_t b = 0; b < 3; b++){
+          const cmplx& u = U[link_index(t, x, y, z, dir)](a, b);
+          T parts[2] = {T(u.real()), T(u.imag())};
+          for(auto& p : parts){
+            to_big_endian(p);
+            const char* bytes = reinterpret_cast<const char*>(&p);
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+          }
+        }
+
+  const std::string format = "<?xml version=\"1.0\"?><ildgFormat/>";
+  std::ofstream file(filename, std::ofstream::binary);
+  write_lime_record(file, "ildg-format",
+                    std::vector<char>(format.begin(), format.end()));
+  write_lime_record(file, "ildg-binary-data", data);
+}
+
+/******************************************************************************/
+/*! W = factor * derivative in direction dir of V, written out with the
+ *  coordinates of the sites
+ */
+Eigen::MatrixXcd naive_derivative(const LinkVector& U, const size_t t,
+                                  const size_t dir, const double factor,
+                                  const Eigen::MatrixXcd& V){
+  Eigen::MatrixXcd W = Eigen::MatrixXcd::Zero(V.rows(), V.cols());
+  for(size_t x = 0; x < Lx; x++)
+  for(size_t y = 0; y < Ly; y++)
+  for(size_t z = 0; z < Lz; z++){
+    size_t fw[3] = {x, y, z}, bw[3] = {x, y, z};
+    const size_t L[3] = {Lx, Ly, Lz};
+    fw[dir] = (fw[dir] + 1) % L[dir];
+    bw[dir] = (bw[dir] + L[dir] - 1) % L[dir];
+    const size_t site = site_index(x, y, z);
+    const size_t forward = site_index(fw[0], fw[1], fw[2]);
+    const size_t backward = site_index(bw[0], bw[1], bw[2]);
+    W.middleRows(3*site, 3) = factor *
+        (U[link_index(t, x, y, z, dir)] * V.middleRows(3*forward, 3) -
+         U[link_index(t, bw[0], bw[1], bw[2], dir)].adjoint() *
+                                          V.middleRows(3*backward, 3));
+  }
+  return W;
+}
+
+/******************************************************************************/
+/*! Runs all checks for one precision, returns the number of failures */
+template <typename T>
+size_t test_precision(const std::string& name, const double tolerance){
+
+  LinkVector U(Lt*volume*4), U_transformed(Lt*volume*4);
+  for(auto& u : U)
+    u = random_unitary();
+  // rounding to the precision of the file gives the links which are read
+  for(auto& u : U)
+    for(size_t i = 0; i < 9; i++)
+      u(i) = cmplx(T(u(i).real()), T(u(i).imag()));
+
+  // U'_d(x) = G(x) U_d(x) G^dagger(x+d), the temporal links are not used
+  LinkVector G(Lt*volume*4);
+  for(auto& g : G)
+    g = random_unitary();
+  auto gauge = [&](const size_t t, const size_t x, const size_t y,
+                   const size_t z) -> const Eigen::Matrix3cd& {
+    return G[link_index(t, x, y, z, 0)];
+  };
+  for(size_t t = 0; t < Lt; t++)
+  for(size_t x = 0; x < Lx; x++)
+  for(size_t y = 0; y < Ly; y++)
+  for(size_t z = 0; z < Lz; z++){
+    const Eigen::Matrix3cd next[3] = {gauge(t, (x + 1) % Lx, y, z),
+                                      gauge(t, x, (y + 1) % Ly, z),
+                                      gauge(t, x, y, (z + 1) % Lz)};
+    for(size_t dir = 0; dir < 3; dir++)
+      U_transformed[link_index(t, x, y, z, dir)] = gauge(t, x, y, z) *
+                      U[link_index(t, x, y, z, dir)] * next[dir].adjoint();
+    U_transformed[link_index(t, x, y, z, 3)] = U[link_index(t, x, y, z, 3)];
+  }
+
+  const std::string filename = "test_gauge_field_" + name + ".lime";
+  const std::string filename_transformed =
+                          "test_gauge_field_" + name + "_transformed.lime";
+  write_configuration<T>(filename, U);
+  write_configuration<T>(filename_transformed, U_transformed);
+
+  size_t failures = 0;
+  auto check = [&](const bool ok, const std::string& what, const size_t t,
+                   const double deviation) {
+    if(!ok){
+      std::cout << "\tFAILED " << name << " t = " << t << ": " << what
+                << ", deviation " << deviation << std::endl;
+      failures++;
+    }
+  };
+
+  LapH::GaugeField field(Lt, Lx, Ly, Lz), field_transformed(Lt, Lx, Ly, Lz);
+  for(size_t t = 0; t < Lt; t++){
+    field.read_timeslice(filename, t);
+    field_transformed.read_timeslice(filename_transformed, t);
+
+    // the links are already rounded to the precision of the file
+    double deviation = 0.;
+    for(size_t x = 0; x < Lx; x++)
+    for(size_t y = 0; y < Ly; y++)
+    for(size_t z = 0; z < Lz; z++)
+      for(size_t dir = 0; dir < 3; dir++)
+        deviation = std::max(deviation,
+                             (field(site_index(x, y, z), dir) -
+                              U[link_index(t, x, y, z, dir)]).norm());
+    check(deviation == 0., "links differ from the written ones", t,
+          deviation);
+
+    const Eigen::MatrixXcd V = Eigen::MatrixXcd::Random(3*volume, nb_ev);
+    Eigen::MatrixXcd V_transformed(3*volume, nb_ev);
+    for(size_t x = 0; x < Lx; x++)
+    for(size_t y = 0; y < Ly; y++)
+    for(size_t z = 0; z < Lz; z++)
+      V_transformed.middleRows(3*site_index(x, y, z), 3) = gauge(t, x, y, z) *
+                                   V.middleRows(3*site_index(x, y, z), 3);
+
+    for(size_t dir = 0; dir < 3; dir++){
+      const double factor = 0.5 + dir;
+      const Eigen::MatrixXcd offset = Eigen::MatrixXcd::Random(3*volume,
+                                                               nb_ev);
+      Eigen::MatrixXcd W = offset;
+      field.add_derivative(dir, factor, V, W);
+      const Eigen::MatrixXcd W_naive =
+                        offset + naive_derivative(U, t, dir, factor, V);
+      deviation = (W - W_naive).norm() / W_naive.norm();
+      check(deviation < 1e-14, "derivative differs from the stencil in "
+            "direction " + std::to_string(dir), t, deviation);
+
+      Eigen::MatrixXcd DV = Eigen::MatrixXcd::Zero(3*volume, nb_ev);
+      Eigen::MatrixXcd DV_transformed = DV;
+      field.add_derivative(dir, factor, V, DV);
+      field_transformed.add_derivative(dir, factor, V_transformed,
+                                       DV_transformed);
+      const Eigen::MatrixXcd vdv = V.adjoint() * DV;
+      deviation = (V_transformed.adjoint() * DV_transformed - vdv).norm() /
+                  vdv.norm();
+      check(deviation < tolerance, "VdaggerDV is not gauge invariant in "
+            "direction " + std::to_string(dir), t, deviation);
+    }
+  }
+  std::remove(filename.c_str());
+  std::remove(filename_transformed.c_str());
+  return failures;
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+int main() {
+
+  size_t failures = test_precision<double>("double", 1e-13);
+  failures += test_precision<float>("single", 1e-5);
+  if(failures){
+    std::cout << "\n" << failures << " checks of LapH::GaugeField failed\n"
+              << std::endl;
+    return 1;
+  }
+  std::cout << "\nAll checks of LapH::GaugeField passed\n" << std::endl;
+  return 0;
+}
@@ -0,0 +1,366 @@
+#include "BinaryReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace {
+
+/*! Large requests are split into chunks of this size, which keeps several
+ *  reads in flight even for a single big request
+ */
+const size_t chunk_size = 64 << 20;
+/*! Maximal number of reads in flight with io_uring */
+const unsigned ring_entries = 64;
+
+/*! Set once the kernel refused to set up a ring, later readers go straight
+ *  to pread
+ */
+std::atomic<bool> io_uring_failed(false);
+
+} // end of unnamed namespace
+
+#if defined(HAVE_IO_URING) && defined(__NR_io_uring_setup)
+/******************************************************************************/
+/*! The ring is set up with raw system calls, thus liburing is not needed */
+struct LapH::BinaryReader::Ring {
+  io_uring_params p;
+  int fd;
+  char* sq_ptr;
+  char* cq_ptr;
+  io_uring_sqe* sqes;
+  size_t sq_map_len;
+  size_t cq_len;
+  size_t sqes_len;
+  bool single_mmap;
+
+  unsigned* sq_tail;
+  unsigned* sq_head;
+  unsigned sq_mask;
+  unsigned* sq_array;
+  unsigned* cq_tail;
+  unsigned* cq_head;
+  unsigned cq_mask;
+  io_uring_cqe* cqes;
+
+  /*! fd is negative if the kernel refuses to set up the ring */
+  Ring(const std::string& filename) {
+    memset(&p, 0, sizeof(p));
+    fd = syscall(__NR_io_uring_setup, ring_entries, &p);
+    if(fd < 0)
+      return;
+
+    const size_t sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+    single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    sq_map_len = single_mmap ? std::max(sq_len, cq_len) : sq_len;
+    sq_ptr = static_cast<char*>(mmap(NULL, sq_map_len,
+                        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_SQ_RING));
+    cq_ptr = sq_ptr;
+    if(sq_ptr != MAP_FAILED && !single_mmap)
+      cq_ptr = static_cast<char*>(mmap(NULL, cq_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING));
+    sqes = static_cast<io_uring_sqe*>(mmap(NULL, sqes_len,
+                        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_SQES));
+    if(sq_ptr == MAP_FAILED || cq_ptr == MAP_FAILED || sqes == MAP_FAILED){
+      std::cout << "failed to map io_uring for reading: " << filename << "\n"
+                << std::endl;
+      exit(0);
+    }
+
+    sq_tail = reinterpret_cast<unsigned*>(sq_ptr + p.sq_off.tail);
+    sq_head = reinterpret_cast<unsigned*>(sq_ptr + p.sq_off.head);
+    sq_mask = *reinterpret_cast<unsigned*>(sq_ptr + p.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq_ptr + p.sq_off.array);
+    cq_tail = reinterpret_cast<unsigned*>(cq_ptr + p.cq_off.tail);
+    cq_head = reinterpret_cast<unsigned*>(cq_ptr + p.cq_off.head);
+    cq_mask = *reinterpret_cast<unsigned*>(cq_ptr + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq_ptr + p.cq_off.cqes);
+  }
+
+  ~Ring() {
+    if(fd < 0)
+      return;
+    munmap(sqes, sqes_len);
+    if(!single_mmap)
+      munmap(cq_ptr, cq_len);
+    munmap(sq_ptr, sq_map_len);
+    close(fd);
+  }
+};
+#else
+struct LapH::BinaryReader::Ring {};
+#endif
+
+/******************************************************************************/
+/*!
+ *  @param filename  Name of the file
+ *  @param io_params io_backend and io_direct decide how the file is read
+ */
+LapH::BinaryReader::BinaryReader(const std::string& filename,
+                                 const IOParameters& io_params) :
+                                        filename(filename),
+                                        backend(io_params.io_backend),
+                                        direct(io_params.io_direct), fd(-1),
+                                        file_size(0), ring() {
+  if(backend != "pread" && backend != "io_uring"){
+    std::cout << "\n\tThe flag io_backend in input file is wrong!!\n\n"
+              << std::endl;
+    exit(0);
+  }
+#ifndef HAVE_IO_URING
+  backend = "pread";
+#endif
+
+  if(direct){
+    fd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+    // e.g. tmpfs does not support O_DIRECT
+    if(fd == -1 && errno == EINVAL)
+      direct = false;
+  }
+  if(!direct)
+    fd = open(filename.c_str(), O_RDONLY);
+  if(fd == -1){
+    std::cout << "failed to open file to read: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  struct stat st;
+  if(fstat(fd, &st) == -1){
+    std::cout << "failed to get size of file: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  file_size = st.st_size;
+}
+
+/******************************************************************************/
+LapH::BinaryReader::~BinaryReader() {
+  for(auto& cb : copy_backs)
+    free(cb.bounce);
+  if(fd != -1)
+    close(fd);
+}
+
+/******************************************************************************/
+void LapH::BinaryReader::add_chunks(char* buf, const size_t len,
+                                    const size_t offset, const size_t min_len) {
+  for(size_t pos = 0; pos < len; pos += chunk_size){
+    const size_t l = std::min(chunk_size, len - pos);
+    const size_t m = pos < min_len ? std::min(l, min_len - pos) : 0;
+    chunks.push_back({buf + pos, l, offset + pos, 0, m});
+  }
+}
+
+/******************************************************************************/
+/*! Reads the enclosing aligned range of the request into a bounce buffer, the
+ *  requested part is copied to dest in wait()
+ */
+void LapH::BinaryReader::add_bounced(char* dest, const size_t nbytes,
+                                     const size_t offset) {
+  const size_t begin = offset - offset % direct_alignment;
+  const size_t end = ((offset + nbytes + direct_alignment - 1) /
+                      direct_alignment) * direct_alignment;
+  void* bounce = NULL;
+  if(posix_memalign(&bounce, direct_alignment, end - begin) != 0){
+    std::cout << "failed to allocate buffer to read: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  copy_backs.push_back({static_cast<char*>(bounce), offset - begin, dest, 
+                        nbytes});
+  add_chunks(static_cast<char*>(bounce), end - begin, begin,
+             offset + nbytes - begin);
+}
+
+/******************************************************************************/
+/*!
+ *  @param dest   Buffer the data are written to
+ *  @param nbytes Number of bytes
+ *  @param offset Position in the file in bytes
+ */
+void LapH::BinaryReader::queue(void* dest, const size_t nbytes,
+                               const size_t offset) {
+  if(nbytes == 0)
+    return;
+  char* d = static_cast<char*>(dest);
+  if(!direct){
+    add_chunks(d, nbytes, offset, nbytes);
+    return;
+  }
+  // O_DIRECT needs aligned requests. If dest and offset are misaligned by the
+  // same amount, only the partial blocks at both ends need a bounce buffer.
+  const size_t head = (direct_alignment - offset % direct_alignment) %
+                      direct_alignment;
+  if((reinterpret_cast<size_t>(d) - offset) % direct_alignment != 0 ||
+     nbytes < head + direct_alignment){
+    add_bounced(d, nbytes, offset);
+    return;
+  }
+  const size_t body = (nbytes - head) - (nbytes - head) % direct_alignment;
+  const size_t tail = nbytes - head - body;
+  if(head > 0)
+    add_bounced(d, head, offset);
+  add_chunks(d + head, body, offset + head, body);
+  if(tail > 0)
+    add_bounced(d + head + body, tail, offset + head + body);
+}
+
+/******************************************************************************/
+void LapH::BinaryReader::read_pread() {
+  for(auto& c : chunks){
+    while(c.done < c.len){
+      const ssize_t res = pread(fd, c.buf + c.done, c.len - c.done,
+                                c.offset + c.done);
+      if(res < 0 && errno == EINTR)
+        continue;
+      if(res < 0){
+        std::cout << "\n\nFailed to read from " << filename << ": "
+                  << strerror(errno) << "\n" << std::endl;
+        exit(0);
+      }
+      if(res == 0)
+        break;
+      c.done += res;
+    }
+  }
+}
+
+/******************************************************************************/
+/*! All chunks are submitted as readv requests to the io_uring of this reader,
+ *  which is set up at the first call. Short reads are resubmitted for the 
+ *  remaining part.
+ *
+ *  @return false if the kernel refuses to set up the ring
+ */
+bool LapH::BinaryReader::read_io_uring() {
+#if defined(HAVE_IO_URING) && defined(__NR_io_uring_setup)
+  if(!ring)
+    ring.reset(new Ring(filename));
+  if(ring->fd < 0)
+    return false;
+  Ring& r = *ring;
+
+  std::vector<iovec> iovs(chunks.size());
+  std::vector<size_t> pending(chunks.size());
+  for(size_t i = 0; i < chunks.size(); i++)
+    pending[i] = chunks.size() - 1 - i;
+  unsigned in_flight = 0;
+  // entries published in the submission queue but not yet consumed by the
+  // kernel, e.g. after an interrupted io_uring_enter
+  unsigned unsubmitted = 0;
+
+  while(!pending.empty() || in_flight > 0){
+    // filling the submission queue
+    unsigned tail = *r.sq_tail;
+    const unsigned head = __atomic_load_n(r.sq_head, __ATOMIC_ACQUIRE);
+    while(!pending.empty() && in_flight < r.p.cq_entries &&
+          tail - head < r.p.sq_entries){
+      const size_t i = pending.back();
+      pending.pop_back();
+      Chunk& c = chunks[i];
+      iovs[i].iov_base = c.buf + c.done;
+      iovs[i].iov_len = c.len - c.done;
+      const unsigned idx = tail & r.sq_mask;
+      io_uring_sqe* sqe = &r.sqes[idx];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = fd;
+      sqe->off = c.offset + c.done;
+      sqe->addr = reinterpret_cast<unsigned long>(&iovs[i]);
+      sqe->len = 1;
+      sqe->user_data = i;
+      r.sq_array[idx] = idx;
+      tail++;
+      unsubmitted++;
+      in_flight++;
+    }
+    __atomic_store_n(r.sq_tail, tail, __ATOMIC_RELEASE);
+
+    const int ret = syscall(__NR_io_uring_enter, r.fd, unsubmitted, 1,
+                            IORING_ENTER_GETEVENTS, NULL, 0);
+    if(ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY){
+      std::cout << "\n\nFailed to submit reads for " << filename << ": "
+                << strerror(errno) << "\n" << std::endl;
+      exit(0);
+    }
+    if(ret > 0)
+      unsubmitted -= ret;
+
+    // harvesting the completion queue
+    unsigned chead = *r.cq_head;
+    const unsigned ctail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+    for(; chead != ctail; chead++){
+      const io_uring_cqe& cqe = r.cqes[chead & r.cq_mask];
+      const size_t i = cqe.user_data;
+      Chunk& c = chunks[i];
+      in_flight--;
+      if(cqe.res == -EINTR || cqe.res == -EAGAIN)
+        pending.push_back(i);
+      else if(cqe.res < 0){
+        std::cout << "\n\nFailed to read from " << filename << ": "
+                  << strerror(-cqe.res) << "\n" << std::endl;
+        exit(0);
+      }
+      else if(cqe.res > 0){
+        c.done += cqe.res;
+        if(c.done < c.len)
+          pending.push_back(i);
+      }
+      // cqe.res == 0 is the end of file, checked in wait()
+    }
+    __atomic_store_n(r.cq_head, chead, __ATOMIC_RELEASE);
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+/******************************************************************************/
+void LapH::BinaryReader::wait() {
+
+  if(backend == "io_uring" && (io_uring_failed || !read_io_uring())){
+    if(!io_uring_failed.exchange(true)){
+      #pragma omp critical (cout)
+      std::cout << "\tio_uring is not available, falling back to pread"
+                << std::endl;
+    }
+    backend = "pread";
+  }
+  if(backend == "pread")
+    read_pread();
+
+  // check if all data were read in
+  for(const auto& c : chunks)
+    if(c.done < c.min_len){
+      std::cout << "\n\nFailed to read all data from " << filename
+                << "\n" << std::endl;
+      exit(0);
+    }
+  chunks.clear();
+
+  for(auto& cb : copy_backs){
+    memcpy(cb.dest, cb.bounce + cb.skip, cb.len);
+    free(cb.bounce);
+  }
+  copy_backs.clear();
+}
+
+/******************************************************************************/
@@ -31,6 +31,15 @@ inline void open_or_create_hdf5_file(const H5std_string FILE_NAME,
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
+static void print_M_cache_statistics(const size_t hits, const size_t misses){
+  if(hits + misses == 0)
+    return;
+  std::cout << "\t\tM of Q2 taken from cache: " << hits << " of " 
+            << hits + misses << " (" << (100.*hits) / (hits + misses) << "%)"
+            << std::endl;
+}
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
 static void write_correlators(const std::vector<cmplx>& corr, 
                               const CorrInfo& corr_info){
   // check if directory exists
@@ -421,16 +430,20 @@ void LapH::Correlators::build_corrC(const Perambulator& perambulators,
 
   corrC.resize(boost::extents[corr_lookup.size()][Lt][Lt]);
 
-#pragma omp parallel
+  size_t M_cache_hits = 0, M_cache_misses = 0;
+#pragma omp parallel reduction(+:M_cache_hits, M_cache_misses)
 {
   // building the quark line directly frees up a lot of memory
   Quarklines_one_t quarklines(2*dilT, dilT, dilE, nev, quark_lookup, 
                         operator_lookup.ricQ2_lookup);
+  // rVdaggerVr, built here per block of timeslices if it is streamed
+  RVdaggerVRBuffer rvdaggervr(meson_operator, dilT);
   #pragma omp for schedule(dynamic)
   for(int t1_i = 0; t1_i < Lt/dilT; t1_i++){
   for(int t2_i = t1_i; t2_i < Lt/dilT; t2_i++){
     quarklines.build_Q2V_one_t(perambulators, meson_operator, t1_i, t2_i,
                               quark_lookup.Q2V, operator_lookup.ricQ2_lookup);
+    rvdaggervr.set_blocks(t1_i, t2_i);
     for(int dir = 0; dir < 2; dir++){
   
       if((t1_i == t2_i) && (dir == 1))
@@ -494,7 +507,7 @@ void LapH::Correlators::build_corrC(const Perambulator& perambulators,
                    quarklines.return_gamma_val(c_look.gamma[0], block) *
                    (quarklines.return_Q2V(id_Q2L_1, 0, c_look.lookup[0], id).
                               block(block*dilE, gamma_index*dilE, dilE, dilE) *
-                   meson_operator.return_rvdaggervr(c_look.lookup[1], t2, id).
+                   rvdaggervr.return_rvdaggervr(c_look.lookup[1], t2, id).
                       block(gamma_index*dilE, block*dilE, dilE, dilE)).trace();
             }
           }
@@ -502,11 +515,14 @@ void LapH::Correlators::build_corrC(const Perambulator& perambulators,
       }}// t1, t2 end here
     }// dir (directions) end here
   }}// block times end here
+  M_cache_hits += quarklines.return_M_cache_hits();
+  M_cache_misses += quarklines.return_M_cache_misses();
 }// omp parall ends here
 
   time = clock() - time;
   std::cout << "\t\tSUCCESS - " << ((float) time) / CLOCKS_PER_SEC 
             << " seconds" << std::endl;
+  print_M_cache_statistics(M_cache_hits, M_cache_misses);
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -676,18 +692,24 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
                                    const std::vector<CorrInfo>& corr_lookup,
                                    const QuarklineLookup& quark_lookup) {
 
+  if(corr_lookup.size() == 0)
+    return;
+
   std::cout << "\tcomputing C4cC:";
   clock_t time = clock();
   
   std::vector<vec> correlator(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
 
+  size_t M_cache_hits = 0, M_cache_misses = 0;
 // This is necessary to ensure the correct summation of the correlation function
-#pragma omp parallel
+#pragma omp parallel reduction(+:M_cache_hits, M_cache_misses)
 {
   std::vector<vec> C(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
   // building the quark line directly frees up a lot of memory
   Quarklines_one_t quarklines(2*dilT, dilT, dilE, nev, quark_lookup, 
                         operator_lookup.ricQ2_lookup);
+  // rVdaggerVr, built here per block of timeslices if it is streamed
+  RVdaggerVRBuffer rvdaggervr(meson_operator, dilT);
   // creating memory arrays M1, M2 for intermediate storage of Quarklines ------
   std::vector<std::vector<Eigen::MatrixXcd> > M1, M2;
   std::vector<std::array<size_t, 3> > M1_look;
@@ -753,6 +775,7 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
     // creating quarklines
     quarklines.build_Q2V_one_t(perambulators, meson_operator, t1_i, t2_i,
                                quark_lookup.Q2V, operator_lookup.ricQ2_lookup);
+    rvdaggervr.set_blocks(t1_i, t2_i);
 
   for(int bla = 0; bla < 2; bla++){
 
@@ -826,7 +849,7 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
           M1[look[0]][M1_rnd_counter].block(0, col*dilE, 4*dilE, dilE) = value *
             quarklines.return_Q2V(id_Q2V_1, 0, look[1], idr0).
                                block(0, gamma_index*dilE, 4*dilE, dilE) *
-            meson_operator.return_rvdaggervr(look[2], t2, idr1).
+            rvdaggervr.return_rvdaggervr(look[2], t2, idr1).
                                 block(gamma_index*dilE, col*dilE, dilE, dilE);
         }
         M1_rnd_counter++;
@@ -856,7 +879,7 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
           M2[look[0]][M2_rnd_counter].block(0, col*dilE, 4*dilE, dilE) = value * 
             quarklines.return_Q2V(id_Q2V_2, 0, look[1], idr2).
                                block(0, gamma_index*dilE, 4*dilE, dilE) *
-            meson_operator.return_rvdaggervr(look[2], t2, idr3).
+            rvdaggervr.return_rvdaggervr(look[2], t2, idr3).
                                 block(gamma_index*dilE, col*dilE, dilE, dilE);
 
         }
@@ -918,6 +941,8 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
       for(size_t t = 0; t < Lt; t++)
         correlator[c_look.id][t] += C[c_look.id][t];
   }
+  M_cache_hits += quarklines.return_M_cache_hits();
+  M_cache_misses += quarklines.return_M_cache_misses();
 }// parallel part ends here
 
   // normalisation
@@ -931,6 +956,7 @@ void LapH::Correlators::build_C4cC(const OperatorsForMesons& meson_operator,
   time = clock() - time;
   std::cout << "\t\t\tSUCCESS - " << ((float) time) / CLOCKS_PER_SEC 
             << " seconds" << std::endl;
+  print_M_cache_statistics(M_cache_hits, M_cache_misses);
 }
 
 // -----------------------------------------------------------------------------
@@ -1044,13 +1070,16 @@ void LapH::Correlators::build_C3c(const OperatorsForMesons& meson_operator,
 
   std::vector<vec> correlator(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
 
+  size_t M_cache_hits = 0, M_cache_misses = 0;
 // This is necessary to ensure the correct summation of the correlation function
-#pragma omp parallel
+#pragma omp parallel reduction(+:M_cache_hits, M_cache_misses)
 {
   std::vector<vec> C(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
   // building the quark line directly frees up a lot of memory
   Quarklines_one_t quarklines(2*dilT, dilT, dilE, nev, quark_lookup, 
                         operator_lookup.ricQ2_lookup);
+  // rVdaggerVr, built here per block of timeslices if it is streamed
+  RVdaggerVRBuffer rvdaggervr(meson_operator, dilT);
   // creating memory arrays M1, M2 for intermediate storage of Quarklines ------
   std::vector<std::vector<Eigen::MatrixXcd> > M1, M2;
   std::vector<std::array<size_t, 3> > M1_look;
@@ -1098,6 +1127,7 @@ void LapH::Correlators::build_C3c(const OperatorsForMesons& meson_operator,
                                quark_lookup.Q2L, operator_lookup.ricQ2_lookup);
     quarklines.build_Q1_mult_t(perambulators, meson_operator, t1_i, t2_i,
                                quark_lookup.Q1, operator_lookup.ricQ2_lookup);
+    rvdaggervr.set_blocks(t1_i, t2_i);
 
   for(int dir = 0; dir < 2; dir++){
 
@@ -1168,7 +1198,7 @@ void LapH::Correlators::build_C3c(const OperatorsForMesons& meson_operator,
                                                           5, col); // TODO: gamma hardcoded
 
           M1[look[0]][M1_rnd_counter].block(col*dilE, 0, dilE, 4*dilE) = value *
-              meson_operator.return_rvdaggervr(look[2], t1, idr2).
+              rvdaggervr.return_rvdaggervr(look[2], t1, idr2).
                                  block(col*dilE, gamma_index*dilE, dilE, dilE) *
               quarklines.return_Q2L(id_Q2L_1, 0, look[1], idr0).
                                  block(gamma_index*dilE, 0, dilE, 4*dilE);
@@ -1217,6 +1247,8 @@ void LapH::Correlators::build_C3c(const OperatorsForMesons& meson_operator,
       for(size_t t = 0; t < Lt; t++)
         correlator[c_look.id][t] += C[c_look.id][t];
   }
+  M_cache_hits += quarklines.return_M_cache_hits();
+  M_cache_misses += quarklines.return_M_cache_misses();
 }// parallel part ends here
 
 
@@ -1231,6 +1263,7 @@ void LapH::Correlators::build_C3c(const OperatorsForMesons& meson_operator,
   time = clock() - time;
   std::cout << "\t\t\tSUCCESS - " << ((float) time) / CLOCKS_PER_SEC 
             << " seconds" << std::endl;
+  print_M_cache_statistics(M_cache_hits, M_cache_misses);
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -1248,13 +1281,16 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
 
   std::vector<vec> correlator(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
 
+  size_t M_cache_hits = 0, M_cache_misses = 0;
 // This is necessary to ensure the correct summation of the correlation function
-#pragma omp parallel
+#pragma omp parallel reduction(+:M_cache_hits, M_cache_misses)
 {
   std::vector<vec> C(corr_lookup.size(), vec(Lt, cmplx(.0,.0)));
   // building the quark line directly frees up a lot of memory
   Quarklines_one_t quarklines(2*dilT, dilT, dilE, nev, quark_lookup, 
                         operator_lookup.ricQ2_lookup);
+  // rVdaggerVr, built here per block of timeslices if it is streamed
+  RVdaggerVRBuffer rvdaggervr(meson_operator, dilT);
   // creating memory arrays M1, M2 for intermediate storage of Quarklines ------
   std::vector<std::vector<Eigen::MatrixXcd> > M1, M2;
   std::vector<std::array<size_t, 3> > M1_look;
@@ -1318,6 +1354,7 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
     // creating quarklines
     quarklines.build_Q2L_one_t(perambulators, meson_operator, t1_i, t2_i,
                                quark_lookup.Q2L, operator_lookup.ricQ2_lookup);
+    rvdaggervr.set_blocks(t1_i, t2_i);
 
   for(int bla = 0; bla < 2; bla++){
 
@@ -1386,7 +1423,7 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
           const size_t gamma_index = quarklines.return_gamma_row(
                                                           5, col); // TODO: gamma hardcoded
           M1[look[0]][M1_rnd_counter].block(col*dilE, 0, dilE, 4*dilE) = value *
-              meson_operator.return_rvdaggervr(look[1], t1, idr1).
+              rvdaggervr.return_rvdaggervr(look[1], t1, idr1).
                                  block(col*dilE, gamma_index*dilE, dilE, dilE) *
               quarklines.return_Q2L(id_Q2L_1, 0, look[2], idr0).
                                  block(gamma_index*dilE, 0, dilE, 4*dilE);
@@ -1413,7 +1450,7 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
           const size_t gamma_index = quarklines.return_gamma_row(5, col); // TODO: gamma hardcoded
           M2[look[0]][M2_rnd_counter].
             block(col*dilE, 0, dilE, 4*dilE) = value *
-            meson_operator.return_rvdaggervr(look[1], t2, idr3).
+            rvdaggervr.return_rvdaggervr(look[1], t2, idr3).
                                 block(col*dilE, gamma_index*dilE, dilE, dilE)*
             quarklines.return_Q2L(id_Q2L_2, 0, look[2], idr2).
                                block(gamma_index*dilE, 0, dilE, 4*dilE);
@@ -1471,6 +1508,8 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
       for(size_t t = 0; t < Lt; t++)
         correlator[c_look.id][t] += C[c_look.id][t];
   }
+  M_cache_hits += quarklines.return_M_cache_hits();
+  M_cache_misses += quarklines.return_M_cache_misses();
 }// parallel part ends here
 
 
@@ -1484,6 +1523,7 @@ void LapH::Correlators::build_C4cB(const OperatorsForMesons& meson_operator,
   time = clock() - time;
   std::cout << "\t\t\tSUCCESS - " << ((float) time) / CLOCKS_PER_SEC 
             << " seconds" << std::endl;
+  print_M_cache_statistics(M_cache_hits, M_cache_misses);
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -1694,6 +1734,50 @@ void LapH::Correlators::build_C40B(const Quarklines& quarklines,
             << " seconds" << std::endl;
 }
 
+/******************************************************************************/
+/*!
+ *  The order is the one of contract(). Only diagrams with entries in 
+ *  corr_lookup are listed, the others return immediately. The one_t 
+ *  quarklines inside the diagrams are built for all entries of the quarkline
+ *  lookup table, thus these are read completely.
+ */
+std::vector<LapH::OperatorUsage> LapH::Correlators::operator_usage(
+                                   const OperatorLookup& operator_lookup,
+                                   const CorrelatorLookup& corr_lookup, 
+                                   const QuarklineLookup& quark_lookup) const {
+
+  std::vector<size_t> Q1, Q2V, Q2L;
+  for(const auto& q : quark_lookup.Q1)
+    Q1.push_back(q.id_rvdaggerv);
+  for(const auto& q : quark_lookup.Q2V)
+    Q2V.push_back(q.id_vdaggerv);
+  for(const auto& q : quark_lookup.Q2L)
+    Q2L.push_back(q.id_vdaggerv);
+  // rvdaggervr entries at the given positions of the correlator lookups
+  auto rvdaggervr = [](const std::vector<CorrInfo>& corr, 
+                       const std::vector<size_t>& positions) 
+                                                  -> std::vector<size_t> {
+    std::vector<size_t> ids;
+    for(const auto& c_look : corr)
+      for(const auto pos : positions)
+        ids.push_back(c_look.lookup[pos]);
+    return ids;
+  };
+
+  std::vector<OperatorUsage> usage;
+  if(!corr_lookup.corrC.empty())
+    usage.push_back({"corrC", Q2V, {}, rvdaggervr(corr_lookup.corrC, {1})});
+  if(!corr_lookup.corr0.empty())
+    usage.push_back({"corr0", {}, Q1, {}});
+  if(!corr_lookup.C3c.empty())
+    usage.push_back({"C3c", Q2L, Q1, rvdaggervr(corr_lookup.C3c, {2})});
+  if(!corr_lookup.C4cC.empty())
+    usage.push_back({"C4cC", Q2V, {}, rvdaggervr(corr_lookup.C4cC, {1, 3})});
+  if(!corr_lookup.C4cB.empty())
+    usage.push_back({"C4cB", Q2L, {}, rvdaggervr(corr_lookup.C4cB, {1, 3})});
+  return usage;
+}
+
 /******************************************************************************/ 
 /*!
  *  @param quarklines       Instance of Quarklines. Contains prebuilt 
@@ -1709,10 +1793,13 @@ void LapH::Correlators::build_C40B(const Quarklines& quarklines,
  *
  *  If a diagram is not specified in the infile, corr_lookup contains an empty
  *  vector for this diagram and the build function immediately returns
+ *
+ *  After each diagram which reads operators, the operators no later diagram
+ *  reads are freed, see operator_usage()
  */
 //void LapH::Correlators::contract (Quarklines& quarklines, 
 void LapH::Correlators::contract (Quarklines& quarklines, 
-                     const OperatorsForMesons& meson_operator,
+                     OperatorsForMesons& meson_operator,
                      const Perambulator& perambulators,
                      const OperatorLookup& operator_lookup,
                      const CorrelatorLookup& corr_lookup, 
@@ -1721,15 +1808,18 @@ void LapH::Correlators::contract (Quarklines& quarklines,
   // 1. Build all functions which need corrC and free it afterwards.
   build_corrC(perambulators, meson_operator, operator_lookup, 
               corr_lookup.corrC, quark_lookup);
+  meson_operator.release_operators("corrC");
   build_C2c(corr_lookup.C2c);
   build_C4cD(operator_lookup, corr_lookup, quark_lookup);
   build_C4cV(operator_lookup, corr_lookup, quark_lookup);
   // 2. Build all functions which need corr0 and free it afterwards.
   build_corr0(meson_operator, perambulators, corr_lookup.corr0, 
               quark_lookup, operator_lookup);
+  meson_operator.release_operators("corr0");
   // in C3c, also corr0 is build, since this is much faster
   build_C3c(meson_operator, perambulators, operator_lookup, corr_lookup.C3c, 
                                                                  quark_lookup);
+  meson_operator.release_operators("C3c");
   build_C20(corr_lookup.C20);
   build_C40D(operator_lookup, corr_lookup, quark_lookup);
   build_C40V(operator_lookup, corr_lookup, quark_lookup);
@@ -1738,10 +1828,12 @@ void LapH::Correlators::contract (Quarklines& quarklines,
                                                  operator_lookup.ricQ2_lookup);
   build_C4cC(meson_operator, perambulators, operator_lookup, corr_lookup.C4cC, 
                                                                  quark_lookup);
+  meson_operator.release_operators("C4cC");
 //  build_C4cC(quarklines, meson_operator, operator_lookup, corr_lookup.C4cC, 
 //                                                                 quark_lookup);
   build_C4cB(meson_operator, perambulators, operator_lookup, corr_lookup.C4cB, 
                                                                  quark_lookup);
+  meson_operator.release_operators("C4cB");
   build_C30(quarklines, corr_lookup.C30, quark_lookup, 
                                                  operator_lookup.ricQ2_lookup);
   build_C40C(quarklines, corr_lookup.C40C, quark_lookup, 
@@ -1,29 +1,36 @@
 #include "EigenVector.h"
 
+#include <sys/mman.h>
+
+#include "BinaryReader.h"
+#include "MappedFile.h"
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::EigenVector::print_check(const size_t t) const {
+
+  // small test of trace and sum over the eigen vector matrix!
+  const Eigen::MatrixXcd VdV = V[t].adjoint() * V[t];
+  std::cout << "trace of V^d*V" << ":\t" << VdV.trace() << std::endl;
+  std::cout << "sum over all entries of V^d*V" << ":\t" << VdV.sum() 
+            << std::endl;
+}
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::EigenVector::read_eigen_vector(const std::string& filename, 
                                           const size_t t, const size_t verbose){
 
-  // buffer for read in
-  vec eigen_vec(V[t].rows());
   std::cout << "\tReading eigenvectors from files:" << filename << std::endl;
 
-  // setting V[t] to zero
-  V[t].setZero();
   // setting up file
   std::ifstream infile(filename, std::ifstream::binary); 
   if (infile) {
-    for (size_t ncol = 0; ncol < V[t].cols(); ++ncol) {
-      std::fill(eigen_vec.begin(), eigen_vec.end(), cmplx(.0, .0));
-      infile.read( (char*) &(eigen_vec[0]), 2*V[t].rows()*sizeof(double));
-      if(!infile){
-        std::cout << "\n\nProblem while reading Eigenvectors\n" << std::endl;
-        exit(0);
-      }
-      for(size_t nrow = 0; nrow < V[t].rows(); ++nrow){
-        (V[t])(nrow, ncol) = eigen_vec[nrow];
-      }
+    // the file is column major as V[t], thus it is read in place at once
+    infile.read(reinterpret_cast<char*>(V[t].data()), 
+                V[t].size()*sizeof(cmplx));
+    if(!infile){
+      std::cout << "\n\nProblem while reading Eigenvectors\n" << std::endl;
+      exit(0);
     }
   }
   else {
@@ -32,13 +39,59 @@ void LapH::EigenVector::read_eigen_vector(const std::string& filename,
   }
   infile.close();
 
-  // small test of trace and sum over the eigen vector matrix!
-  if(verbose){
-    std::cout << "trace of V^d*V" << ":\t"
-        << (V[t].adjoint() * V[t]).trace() << std::endl;
-    std::cout << "sum over all entries of V^d*V" << ":\t"
-        << (V[t].adjoint() * V[t]).sum() << std::endl;
-  }   
+  if(verbose)
+    print_check(t);
+}
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::EigenVector::read_eigen_vector_mmap(const std::string& filename, 
+                                               const size_t t, 
+                                               const size_t verbose){
+
+  std::cout << "\tReading eigenvectors from files:" << filename << std::endl;
+
+  MappedFile file(filename);
+  if(file.size() < V[t].size()*sizeof(cmplx)){
+    std::cout << "\n\nProblem while reading Eigenvectors\n" << std::endl;
+    exit(0);
+  }
+  file.advise(MADV_SEQUENTIAL);
+  // the layout matches, thus the mapping is viewed as matrix directly
+  V[t] = Eigen::Map<const Eigen::MatrixXcd>(
+                               reinterpret_cast<const cmplx*>(file.data()), 
+                               V[t].rows(), V[t].cols());
+
+  if(verbose)
+    print_check(t);
+}
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::EigenVector::read_eigen_vector(const std::string& filename, 
+                                          const size_t t, const size_t verbose,
+                                          const IOParameters& io_params){
+
+  if(io_params.handling_eigenvectors == "mmap"){
+    read_eigen_vector_mmap(filename, t, verbose);
+    return;
+  }
+  else if(io_params.handling_eigenvectors != "read"){
+    std::cout << "\n\tThe flag handling_eigenvectors in input file is "
+              << "wrong!!\n\n" << std::endl;
+    exit(0);
+  }
+  if(io_params.io_backend == "stdio"){
+    read_eigen_vector(filename, t, verbose);
+    return;
+  }
+  std::cout << "\tReading eigenvectors from files:" << filename << std::endl;
+
+  // the file is column major as V[t], thus it is read in place at once
+  BinaryReader infile(filename, io_params);
+  infile.queue(V[t].data(), V[t].size() * sizeof(cmplx), 0);
+  infile.wait();
+
+  if(verbose)
+    print_check(t);
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
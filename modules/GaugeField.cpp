@@ -0,0 +1,168 @@
+#include "GaugeField.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+/******************************************************************************/
+/*! Converts n numbers from big endian to the byte order of the machine */
+template <typename T>
+void from_big_endian(T* data, const size_t n){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  for(size_t i = 0; i < n; i++){
+    char* bytes = reinterpret_cast<char*>(data + i);
+    std::reverse(bytes, bytes + sizeof(T));
+  }
+#endif
+}
+
+/******************************************************************************/
+/*! Looks for the record "ildg-binary-data" in a LIME file
+ *
+ *  @param[in]  file   The opened file
+ *  @param[out] offset Position of the data of the record
+ *  @param[out] length Length of the data in bytes, 0 if there is no such
+ *                     record
+ *
+ *  Every LIME record starts with a header of 144 bytes: the magic number,
+ *  version and flags, the length of the data as uint64_t and the type of
+ *  the record. The data is padded to a multiple of 8 bytes.
+ */
+void find_ildg_binary_data(std::ifstream& file, std::streamoff& offset,
+                           uint64_t& length){
+  const uint32_t lime_magic = 0x456789ab;
+  char header[144];
+  std::streamoff pos = 0;
+  length = 0;
+  while(file.seekg(pos) && file.read(header, 144)){
+    uint32_t magic;
+    uint64_t record_length;
+    memcpy(&magic, header, 4);
+    memcpy(&record_length, header + 8, 8);
+    from_big_endian(&magic, 1);
+    from_big_endian(&record_length, 1);
+    if(magic != lime_magic)
+      return;
+    if(std::string(header + 16, strnlen(header + 16, 128)) ==
+                                                          "ildg-binary-data"){
+      offset = pos + 144;
+      length = record_length;
+      return;
+    }
+    pos += 144 + (record_length + 7) / 8 * 8;
+  }
+}
+
+} // internal namespace ends here
+
+/******************************************************************************/
+/*!
+ *  @param Lt, Lx, Ly, Lz Temporal and spatial lattice extent
+ */
+LapH::GaugeField::GaugeField(const size_t Lt, const size_t Lx, const size_t Ly,
+                             const size_t Lz) : Lt(Lt), Lx(Lx), Ly(Ly), Lz(Lz),
+                                                volume(Lx*Ly*Lz),
+                                                links(3*Lx*Ly*Lz) {}
+
+/******************************************************************************/
+size_t LapH::GaugeField::neighbour(const size_t site, const size_t dir,
+                                   const int step) const {
+  const size_t extent[3] = {Lx, Ly, Lz};
+  const size_t stride[3] = {Ly*Lz, Lz, 1};
+  const size_t L = extent[dir];
+  const size_t x = (site / stride[dir]) % L;
+  const size_t x_new = (x + L + step) % L;
+  return site - x*stride[dir] + x_new*stride[dir];
+}
+
+/******************************************************************************/
+void LapH::GaugeField::read_timeslice(const std::string& filename,
+                                      const size_t t){
+
+  std::cout << "\tReading gauge field from file:" << filename << " t = " << t
+            << std::endl;
+
+  std::ifstream file(filename, std::ifstream::binary);
+  if(!file){
+    std::cout << "gauge configuration " << filename << " does not exist!!!\n"
+              << std::endl;
+    exit(0);
+  }
+  std::streamoff offset;
+  uint64_t length;
+  find_ildg_binary_data(file, offset, length);
+
+  // 4 directions with 3x3 complex numbers on every site
+  const size_t nb_reals = Lt*volume*4*9*2;
+  size_t precision = 0;
+  if(length == nb_reals*sizeof(double))
+    precision = sizeof(double);
+  else if(length == nb_reals*sizeof(float))
+    precision = sizeof(float);
+  else{
+    std::cout << "\n\n" << filename << " has no ildg-binary-data record for a "
+              << Lt << "x" << Lx << "x" << Ly << "x" << Lz << " lattice\n"
+              << std::endl;
+    exit(0);
+  }
+
+  // the timeslices are stored one after another
+  const size_t bytes_per_site = 4*9*2*precision;
+  std::vector<char> buffer(volume*bytes_per_site);
+  file.clear();
+  file.seekg(offset + t*volume*bytes_per_site);
+  file.read(buffer.data(), buffer.size());
+  if(!file){
+    std::cout << "\n\nProblem while reading the gauge field\n" << std::endl;
+    exit(0);
+  }
+
+  auto entry = [&](const size_t i) -> double {
+    if(precision == sizeof(double)){
+      double d;
+      memcpy(&d, &buffer[i*sizeof(double)], sizeof(double));
+      from_big_endian(&d, 1);
+      return d;
+    }
+    float f;
+    memcpy(&f, &buffer[i*sizeof(float)], sizeof(float));
+    from_big_endian(&f, 1);
+    return f;
+  };
+  for(size_t x = 0; x < Lx; x++){
+  for(size_t y = 0; y < Ly; y++){
+  for(size_t z = 0; z < Lz; z++){
+    const size_t site = x*Ly*Lz + y*Lz + z;
+    const size_t site_ildg = (z*Ly + y)*Lx + x;
+    for(size_t dir = 0; dir < 3; dir++)
+      for(size_t a = 0; a < 3; a++)
+        for(size_t b = 0; b < 3; b++){
+          const size_t i = 2*((site_ildg*4 + dir)*9 + 3*a + b);
+          links[3*site + dir](a, b) = cmplx(entry(i), entry(i+1));
+        }
+  }}}
+}
+
+/******************************************************************************/
+/*!
+ *  The three colour rows of a site are multiplied with the links as a
+ *  3 x nb_ev block.
+ */
+void LapH::GaugeField::add_derivative(const size_t dir, const double factor,
+                                      const Eigen::MatrixXcd& V,
+                                      Eigen::MatrixXcd& W) const {
+  for(size_t site = 0; site < volume; site++){
+    const size_t forward = neighbour(site, dir, 1);
+    const size_t backward = neighbour(site, dir, -1);
+    const Eigen::Matrix3cd U_forward = factor * links[3*site + dir];
+    const Eigen::Matrix3cd U_backward =
+                                factor * links[3*backward + dir].adjoint();
+    W.middleRows(3*site, 3).noalias() +=
+                                  U_forward * V.middleRows(3*forward, 3);
+    W.middleRows(3*site, 3).noalias() -=
+                                  U_backward * V.middleRows(3*backward, 3);
+  }
+}
@@ -77,6 +77,76 @@ void GlobalData::read_parameters (int ac, char* av[]) {
       po::value<size_t>(&nb_eigen_threads)->default_value(1),
       "nb_eigen_threads: number of threads Eigen uses internally");
 
+  // input/output options
+  config.add_options()
+    ("handling_perambulators",
+      po::value<std::string>(&io_params.handling_perambulators)->
+                                                        default_value("read"),
+      "The options are:\n"
+      "read: perambulators are read into a buffer and reordered\n"
+      "mmap: perambulators are memory mapped and reordered in parallel\n"
+      "stream: perambulators are read and reordered in slabs, the extra "
+      "memory is bounded by perambulator_buffer_size")
+    ("handling_eigenvectors",
+      po::value<std::string>(&io_params.handling_eigenvectors)->
+                                                        default_value("read"),
+      "The options are:\n"
+      "read: eigenvectors are read in place into the matrices\n"
+      "mmap: eigenvectors are memory mapped and copied into the matrices")
+    ("perambulator_precision",
+      po::value<std::string>(&io_params.perambulator_precision)->
+                                                      default_value("double"),
+      "perambulator_precision: double or single. In single precision the "
+      "perambulators need half of the memory, quarklines are still computed "
+      "in double precision")
+    ("perambulator_file_precision",
+      po::value<std::string>(&io_params.perambulator_file_precision)->
+                                                      default_value("double"),
+      "perambulator_file_precision: double or single, precision of the "
+      "numbers in the perambulator files")
+    ("perambulator_buffer_size",
+      po::value<size_t>(&io_params.perambulator_buffer_size)->
+                                                          default_value(256),
+      "Size of the slab buffer in MB when handling_perambulators = stream")
+    ("nb_io_threads",
+      po::value<size_t>(&io_params.nb_io_threads)->default_value(1),
+      "nb_io_threads: number of perambulator and random vector files which "
+      "are read concurrently, at least 1. With vdaggerv_queue_depth > 0 also "
+      "the number of threads reading eigenvectors")
+    ("vdaggerv_queue_depth",
+      po::value<size_t>(&io_params.vdaggerv_queue_depth)->default_value(0),
+      "vdaggerv_queue_depth: number of eigenvector timeslices buffered "
+      "between reading and building VdaggerV. 0: every thread reads its own "
+      "timeslice and computes afterwards")
+    ("io_backend",
+      po::value<std::string>(&io_params.io_backend)->default_value("stdio"),
+      "The options are:\n"
+      "stdio: binary files are read with fread and ifstream\n"
+      "pread: reads are queued and issued with pread\n"
+      "io_uring: reads are queued and submitted at once via io_uring, falls "
+      "back to pread if not available")
+    ("io_direct",
+      po::value<bool>(&io_params.io_direct)->default_value(false),
+      "io_direct: bypass the page cache with O_DIRECT when io_backend is "
+      "pread or io_uring")
+    ("vdaggerv_access",
+      po::value<std::string>(&io_params.vdaggerv_access)->
+                                                        default_value("eager"),
+      "The options are:\n"
+      "eager: VdaggerV is read completely into memory\n"
+      "lazy: VdaggerV files are memory mapped and only the timeslices which "
+      "are used are paged in. Only for handling_vdaggerv = read and "
+      "read_container")
+    ("prefetch_config",
+      po::value<bool>(&io_params.prefetch_config)->default_value(false),
+      "prefetch_config: read perambulators and random vectors of the next "
+      "configuration while the current one is contracted. Needs memory for "
+      "a second set, otherwise the configurations are processed serially. "
+      "The background reader uses nb_io_threads OpenMP threads. The "
+      "eigenvectors, gauge configuration and VdaggerV files of the next "
+      "configuration are only hinted to the page cache and read when the "
+      "operators are built");
+
   // lattice options
   config.add_options()
     ("output_path",
@@ -89,6 +159,11 @@ void GlobalData::read_parameters (int ac, char* av[]) {
     ("path_config",
       po::value<std::string>(&path_config)->default_value("../../configs"),
       "path for configurations")
+    ("name_config",
+      po::value<std::string>(&name_config)->default_value("conf"),
+      "name of the gauge configurations in ILDG format, the full name is "
+      "\"name_config.configuration\". Only read to build displaced "
+      "operators")
     ("lattice", 
       po::value<std::string>(&name_lattice)-> default_value("lattice"),
       "Codename of the lattice")
@@ -123,10 +198,30 @@ void GlobalData::read_parameters (int ac, char* av[]) {
       "The options are:\n"
       "build: VdaggerV is build for all operators but not written to disk\n"
       "write: VdaggerV is build for all operators and written to disk\n"
-      "read: VdaggerV was previously constructed and is read from disk")
+      "write_container: as write, but all operators and timeslices of a "
+      "configuration go into a single indexed file\n"
+      "read: VdaggerV was previously constructed and is read from disk\n"
+      "read_container: VdaggerV is read from the file written with "
+      "write_container")
     ("path_vdaggerv",
       po::value<std::string>(&path_vdaggerv)->default_value(""),
-      "Path of vdaggerv");
+      "Path of vdaggerv")
+    ("vdaggerv_engine",
+      po::value<std::string>(&vdaggerv_engine)->default_value("auto"),
+      "How VdaggerV is built from the eigenvectors:\n"
+      "direct: one sum over the lattice per momentum\n"
+      "fft: all momenta from a 3d FFT of the products of the eigenvectors on "
+      "each site, pays off for many momenta\n"
+      "auto: fft if the number of momenta exceeds 4*log2(Lx*Ly*Lz)\n"
+      "benchmark: both, the timings and the deviation are printed. The "
+      "GFLOP/s of direct are printed per timeslice whenever it is used")
+    ("handling_rvdaggervr",
+      po::value<std::string>(&handling_rvdaggervr)->default_value("store"),
+      "The options are:\n"
+      "store: rVdaggerVr is built for all timeslices with the other operators "
+      "and kept until the last diagram reading it\n"
+      "stream: the diagrams build rVdaggerVr for the two blocks of timeslices "
+      "they work on into a buffer of each thread, VdaggerV is kept instead");
 
   // quark options
   config.add_options()
@@ -201,6 +296,11 @@ void GlobalData::read_parameters (int ac, char* av[]) {
     po::notify(vm);
   }
   ifs.close();
+  if(io_params.nb_io_threads == 0){
+    std::cout << "\ninput file error:\n" << "\toption \"nb_io_threads\""
+              << " must be an integer greater than 0!" << "\n\n";
+    exit(0);
+  }
 
   /****************************************************************************/
 
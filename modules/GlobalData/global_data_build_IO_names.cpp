@@ -69,6 +69,17 @@ static std::string create_eigenvector_file_name (
   sprintf(name, "%s.%04d.", filename.c_str(), (int) config);
   return name;
 
+}
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+static std::string create_config_file_name (const size_t config,
+                                            const std::string& path_config,
+                                            const std::string& name_config) {
+  char name[200];
+  std::string filename = path_config + "/" + name_config;
+  sprintf(name, "%s.%04d", filename.c_str(), (int) config);
+  return name;
+
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
@@ -84,4 +95,5 @@ void GlobalData::build_IO_names(const size_t config){
                                                 config, Lt, Lx, Ly, Lz, quarks);
   filename_eigenvectors = create_eigenvector_file_name(config, 
                                           path_eigenvectors, name_eigenvectors);
+  filename_config = create_config_file_name(config, path_config, name_config);
 }
@@ -0,0 +1,57 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/******************************************************************************/
+/*!
+ *  @param filename Name of the file which is mapped
+ *
+ *  The file descriptor is closed right after mapping - the mapping itself
+ *  keeps the file alive.
+ */
+LapH::MappedFile::MappedFile(const std::string& filename) : addr(NULL),
+                                                            length(0) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if(fd == -1){
+    std::cout << "failed to open file to map: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  struct stat st;
+  if(fstat(fd, &st) == -1){
+    std::cout << "failed to get size of file: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  length = st.st_size;
+  if(length > 0){
+    addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(addr == MAP_FAILED){
+      std::cout << "failed to map file: " << filename << "\n" << std::endl;
+      exit(0);
+    }
+  }
+  close(fd);
+}
+
+/******************************************************************************/
+LapH::MappedFile::~MappedFile() {
+  if(addr != NULL)
+    munmap(addr, length);
+}
+
+/******************************************************************************/
+/*!
+ *  @param advice One of the MADV_* constants of madvise(2)
+ *
+ *  Only a hint, failures are silently ignored.
+ */
+void LapH::MappedFile::advise(const int advice) const {
+  if(addr != NULL)
+    madvise(addr, length, advice);
+}
+
+/******************************************************************************/
@@ -7,42 +7,333 @@
 
 #include "OperatorsForMesons.h"
 
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "omp.h"
+#include "unsupported/Eigen/FFT"
+
+#include "BinaryReader.h"
+#include "PhaseScaling.h"
+#include "GaugeField.h"
+#include "VdaggerVContainer.h"
+
 namespace {
 
-/*! Creates a two-dimensional vector containing the momenta for the operators 
+/*! Creates the phases of the momenta for the operators separately for each 
+ *  direction
  *
  *  @param[in] Lx, Ly, Lz      Lattice extent in spatial directions
  *  @param[in] vdaggerv_lookup Contains the momenta
- *  @param[in,out] momentum    Two dimensional array where the momenta are 
- *                             stored
+ *  @param[in,out] momentum    momentum[d][op.id][x_d] is exp(-ip_d x_d) for
+ *                             direction d
+ *
+ *  exp(-ipx) on a site is the product of the three phases. Thus only 
+ *  Lx+Ly+Lz instead of Lx*Ly*Lz numbers per operator are stored.
  */
 void create_momenta(const size_t Lx, const size_t Ly, const size_t Lz, 
                     const std::vector<VdaggerVQuantumNumbers>& vdaggerv_lookup, 
-                    array_cd_d2& momentum){
+                    std::array<array_cd_d2, 3>& momentum){
   static const std::complex<double> I(0.0, 1.0);
+  const size_t L[3] = {Lx, Ly, Lz};
+
+  for(size_t d = 0; d < 3; d++){
+    momentum[d].resize(boost::extents[vdaggerv_lookup.size()][L[d]]);
+    for(const auto& op : vdaggerv_lookup){
+      const double ip = op.momentum[d] * 2. * M_PI / (double) L[d];
+      for(size_t x = 0; x < L[d]; ++x)
+        momentum[d][op.id][x] = exp(-I * (ip * x));
+    }
+  }
+}
+
+/******************************************************************************/
+/*! Size of the row blocks of V in vdaggerv_all_momenta(). The block and its
+ *  phase weighted copy fit into L2 cache together.
+ */
+const size_t vdaggerv_block_bytes = 512 << 10;
+
+/******************************************************************************/
+/*! Computes @f$ V^\dagger diag(exp(-ipx)) DV @f$ for several momenta in one
+ *  pass over V and DV
+ *
+ *  @param[in]  V        Eigenvectors of one timeslice, 3*volume x nb_ev
+ *  @param[in]  DV       V itself or its covariant derivative for displaced 
+ *                       operators, same size as V
+ *  @param[in]  momentum Phases for all operators, see create_momenta()
+ *  @param[in]  ids      Operators to compute
+ *  @param[out] vdv      One matrix per entry of ids
+ *
+ *  V and DV are processed in blocks of rows. Each block is multiplied with 
+ *  the phases of all momenta while it is in cache, thus V is streamed from 
+ *  memory once instead of once per momentum. The phase of a site is built 
+ *  from the phases of its coordinates, one per site, and the block is 
+ *  scaled with the SIMD kernels of LapH::scale_by_phase().
+ */
+void vdaggerv_all_momenta(const Eigen::MatrixXcd& V, 
+                          const Eigen::MatrixXcd& DV,
+                          const std::array<array_cd_d2, 3>& momentum, 
+                          const std::vector<size_t>& ids,
+                          std::vector<Eigen::MatrixXcd*>& vdv){
+
+  const size_t dim_row = V.rows();
+  const size_t nb_ev = V.cols();
+  const size_t Ly = momentum[1].shape()[1];
+  const size_t Lz = momentum[2].shape()[1];
+  // a multiple of 3, thus a block contains complete lattice sites
+  const size_t block = std::max(size_t(3), 
+                  vdaggerv_block_bytes / (2 * nb_ev * sizeof(cmplx)) / 3 * 3);
+
+  for(auto m : vdv)
+    m->setZero(nb_ev, nb_ev);
+  Eigen::MatrixXcd W(std::min(block, dim_row), nb_ev);
+  std::vector<cmplx> phase(std::min(block, dim_row) / 3);
+
+  for(size_t row = 0; row < dim_row; row += block){
+    const size_t nb_rows = std::min(block, dim_row - row);
+    const auto V_block = V.middleRows(row, nb_rows);
+    for(size_t i = 0; i < ids.size(); i++){
+      const auto px = momentum[0][ids[i]];
+      const auto py = momentum[1][ids[i]];
+      const auto pz = momentum[2][ids[i]];
+      size_t z = (row/3) % Lz, y = (row/3/Lz) % Ly, x = row/3/(Ly*Lz);
+      cmplx pxy = px[x] * py[y];
+      // All three colours on same lattice site get the same momentum.
+      for(size_t r = 0; r < nb_rows; r += 3){
+        phase[r/3] = pxy * pz[z];
+        if(++z == Lz){
+          z = 0;
+          if(++y == Ly){
+            y = 0;
+            ++x;
+          }
+          if(r + 3 < nb_rows)
+            pxy = px[x] * py[y];
+        }
+      }
+      LapH::scale_by_phase(DV.data() + row, dim_row, phase.data(), 
+                           nb_rows/3, nb_ev, W.data(), W.rows());
+      vdv[i]->noalias() += V_block.adjoint() * W.topRows(nb_rows);
+    }
+  }
+}
+
+/******************************************************************************/
+/*! In-place forward FFT of a field on the spatial lattice
+ *
+ *  @param[in]     fft        FFT object, it caches the twiddle factors
+ *  @param[in]     Lx, Ly, Lz Lattice extent in spatial directions
+ *  @param[in,out] field      Site index x*Ly*Lz + y*Lz + z, afterwards
+ *                            @f$ \sum_x exp(-ipx) field(x) @f$ at the same
+ *                            index for p = 2pi/L*(px, py, pz)
+ *  @param[in]     in, out    Scratch space for the one dimensional transforms
+ */
+void fft_3d(Eigen::FFT<double>& fft, const size_t Lx, const size_t Ly, 
+            const size_t Lz, cmplx* field, std::vector<cmplx>& in, 
+            std::vector<cmplx>& out){
+
+  const size_t extent[3] = {Lx, Ly, Lz};
+  const size_t stride[3] = {Ly*Lz, Lz, 1};
+  const size_t volume = Lx*Ly*Lz;
+  for(size_t d = 0; d < 3; d++){
+    const size_t L = extent[d];
+    if(L == 1)
+      continue;
+    in.resize(L);
+    out.resize(L);
+    // one transform for every line in direction d, i.e. every site with 
+    // coordinate 0 in direction d
+    for(size_t site = 0; site < volume; site++){
+      if((site / stride[d]) % L != 0)
+        continue;
+      for(size_t i = 0; i < L; i++)
+        in[i] = field[site + i*stride[d]];
+      fft.fwd(out, in);
+      for(size_t i = 0; i < L; i++)
+        field[site + i*stride[d]] = out[i];
+    }
+  }
+}
+
+/******************************************************************************/
+/*! Computes @f$ V^\dagger diag(exp(-ipx)) V @f$ for several momenta with fast 
+ *  Fourier transforms
+ *
+ *  @param[in]  V          Eigenvectors of one timeslice, 3*volume x nb_ev
+ *  @param[in]  Lx, Ly, Lz Lattice extent in spatial directions
+ *  @param[in]  momenta    Momenta in units of 2pi/L
+ *  @param[out] vdv        One matrix per entry of momenta
+ *
+ *  For every pair of eigenvectors a <= b the colour summed product 
+ *  @f$ V_a^*(x) V_b(x) @f$ is Fourier transformed, which gives element (a,b) 
+ *  for all momenta at once. Element (b,a) is the complex conjugate of (a,b) 
+ *  at -p. The cost is nb_ev^2/2 transforms of O(volume log(volume)) instead 
+ *  of O(volume nb_ev^2) per momentum in vdaggerv_all_momenta().
+ */
+void vdaggerv_fft(const Eigen::MatrixXcd& V, const size_t Lx, const size_t Ly,
+                  const size_t Lz, 
+                  const std::vector<std::array<int, 3> >& momenta,
+                  std::vector<Eigen::MatrixXcd*>& vdv){
+
+  typedef Eigen::Map<const Eigen::VectorXcd, 0, Eigen::InnerStride<3> > 
+                                                                       Colour;
+  const size_t volume = Lx*Ly*Lz;
+  const size_t nb_ev = V.cols();
+
+  // positions of p and -p in the transformed field
+  auto site = [&](const int px, const int py, const int pz) {
+    const int L[3] = {int(Lx), int(Ly), int(Lz)};
+    const int p[3] = {px, py, pz};
+    size_t index = 0;
+    for(size_t d = 0; d < 3; d++)
+      index = index*L[d] + ((p[d] % L[d]) + L[d]) % L[d];
+    return index;
+  };
+  std::vector<size_t> plus, minus;
+  for(const auto& p : momenta){
+    plus.push_back(site(p[0], p[1], p[2]));
+    minus.push_back(site(-p[0], -p[1], -p[2]));
+  }
+
+  for(auto m : vdv)
+    m->resize(nb_ev, nb_ev);
+  Eigen::FFT<double> fft;
+  std::vector<cmplx> in, out;
+  Eigen::VectorXcd field(volume);
+  for(size_t a = 0; a < nb_ev; a++){
+    for(size_t b = a; b < nb_ev; b++){
+      field.setZero();
+      for(size_t c = 0; c < 3; c++)
+        field += Colour(V.col(a).data() + c, volume).conjugate().
+                              cwiseProduct(Colour(V.col(b).data() + c, volume));
+      fft_3d(fft, Lx, Ly, Lz, field.data(), in, out);
+      for(size_t i = 0; i < momenta.size(); i++){
+        (*vdv[i])(a, b) = field(plus[i]);
+        (*vdv[i])(b, a) = std::conj(field(minus[i]));
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+/*! Entries of one random vector belonging to the eigenvectors of one Dirac 
+ *  component on timeslice t
+ */
+Eigen::VectorXcd dirac_block_entries(const LapH::RandomVector& rnd_vec, 
+                                     const size_t rnd_id, const size_t t,
+                                     const size_t block, const size_t nb_ev){
+  Eigen::VectorXcd r(nb_ev);
+  for(size_t vec_i = 0; vec_i < nb_ev; vec_i++)
+    r(vec_i) = rnd_vec(rnd_id, block + 4*(vec_i + nb_ev*t));
+  return r;
+}
+
+/******************************************************************************/
+/*! Applies interlaced eigenvector dilution from the left:
+ *  R(offset + i%dilE, :) += r(i) * A(i, :) for all rows i of A
+ *
+ *  Row i%dilE collects the rows i, i+dilE, i+2dilE, ... thus A is split into
+ *  blocks of dilE rows which are scaled and added as a whole.
+ */
+template <typename Matrix>
+void add_diluted_rows(const Matrix& A, const Eigen::VectorXcd& r, 
+                      const size_t dilE, const size_t offset, 
+                      Eigen::MatrixXcd& R){
+  for(size_t k = 0; k < size_t(A.rows()); k += dilE){
+    const size_t h = std::min(dilE, size_t(A.rows()) - k);
+    R.middleRows(offset, h).noalias() += 
+                              r.segment(k, h).asDiagonal() * A.middleRows(k, h);
+  }
+}
+
+/******************************************************************************/
+/*! Applies interlaced eigenvector dilution from the right:
+ *  R(:, offset + i%dilE) += A(:, i) * r(i) for all columns i of A
+ */
+template <typename Matrix>
+void add_diluted_cols(const Matrix& A, const Eigen::VectorXcd& r, 
+                      const size_t dilE, const size_t offset, 
+                      Eigen::MatrixXcd& R){
+  for(size_t k = 0; k < size_t(A.cols()); k += dilE){
+    const size_t h = std::min(dilE, size_t(A.cols()) - k);
+    R.middleCols(offset, h).noalias() += 
+                              A.middleCols(k, h) * r.segment(k, h).asDiagonal();
+  }
+}
 
-  /*! To calculate Vdagger exp(i*p*x) V only the momenta corresponding to the
-   *  quantum number id in op_VdaggerV will be used. The rest can be obtained
-   *  by adjoining
-   */
-  for(const auto& op : vdaggerv_lookup){
-    // op_VdaggerV contains the index of one (redundancy) op_Corr which
-    // allows to deduce the quantum numbers (momentum)
-    const double ipx = op.momentum[0] * 2. * M_PI / (double) Lx; 
-    const double ipy = op.momentum[1] * 2. * M_PI / (double) Ly;
-    const double ipz = op.momentum[2] * 2. * M_PI / (double) Lz;
-    // calculate \vec{p} \cdot \vec{x} for all \vec{x} on the lattice
-    for(int x = 0; x < Lx; ++x){
-      const int xH = x * Ly * Lz; // helper variable
-      const double ipxH = ipx * x; // helper variable
-      for(int y = 0; y < Ly; ++y){
-        const int xHyH = xH + y * Lz; // helper variable
-        const double ipxHipyH = ipxH + ipy * y; // helper variable
-        for(int z = 0; z < Lz; ++z){
-          // multiply \vec{p} \cdot \vec{x} with complex unit and exponentiate
-          momentum[op.id][xHyH + z] = exp(-I * (ipxHipyH + ipz * z));
-    }}}//loops over spatial vectors end here
-  }//loop over redundant quantum numbers ends here
+/******************************************************************************/
+/*! add_diluted_rows() for A = 1: R(offset + i%dilE, i) += r(i) */
+void add_diluted_unity_rows(const Eigen::VectorXcd& r, const size_t dilE,
+                            const size_t offset, Eigen::MatrixXcd& R){
+  for(size_t i = 0; i < size_t(r.size()); i++)
+    R(offset + i%dilE, i) += r(i);
+}
+
+/******************************************************************************/
+/*! Part of the VdaggerV file names identifying the operator, ".p_" and the 
+ *  momentum. The displacement is only appended if it is not zero, thus the 
+ *  names of the other operators do not change. Its components are separated
+ *  by underscores, e.g. ".d_1_10_0", since they may have several digits.
+ */
+std::string vdaggerv_file_name(const VdaggerVQuantumNumbers& op){
+  std::string name = ".p_" + std::to_string(op.momentum[0]) + 
+                             std::to_string(op.momentum[1]) + 
+                             std::to_string(op.momentum[2]);
+  if(op.displacement != std::array<int, 3>({{0, 0, 0}}))
+    name += ".d_" + std::to_string(op.displacement[0]) + 
+            "_" + std::to_string(op.displacement[1]) + 
+            "_" + std::to_string(op.displacement[2]);
+  return name;
+}
+
+/******************************************************************************/
+/*! Minimal thread safe FIFO: pop() blocks until an element is available */
+template <typename T>
+class BlockingQueue {
+
+private:
+  std::deque<T> queue;
+  std::mutex mutex;
+  std::condition_variable cond;
+
+public:
+  void push(const T& element){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(element);
+    }
+    cond.notify_one();
+  }
+  T pop(){
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]{ return !queue.empty(); });
+    T element = queue.front();
+    queue.pop_front();
+    return element;
+  }
+};
+
+/******************************************************************************/
+/*! Asks the kernel to read a file into the page cache in the background
+ *
+ *  @param filename Name of the file, missing files are silently ignored
+ */
+void readahead_file(const std::string& filename){
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if(fd == -1)
+    return;
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
 }
 
 /******************************************************************************/
@@ -85,6 +376,9 @@ void write_vdaggerv(const std::string& pathname, const std::string& filename,
  * @param operator_lookuptable ?
  * @param handling_vdaggerv
  * @param path_vdaggerv
+ * @param vdaggerv_engine direct, fft, auto or benchmark, see build_vdaggerv()
+ * @param handling_rvdaggervr store or stream, see LapH::RVdaggerVRBuffer
+ * @param io_params       How eigenvector and VdaggerV files are read
  *
  * The initialization of the container attributes of LapH::OperatorsForMesons
  * is done in the member initializer list of the constructor. The allocation
@@ -95,12 +389,24 @@ LapH::OperatorsForMesons::OperatorsForMesons
                          const size_t Lz, const size_t nb_ev, const size_t dilE,
                          const OperatorLookup& operator_lookuptable,
                          const std::string& handling_vdaggerv,
-                         const std::string& path_vdaggerv) : 
+                         const std::string& path_vdaggerv,
+                         const std::string& vdaggerv_engine,
+                         const std::string& handling_rvdaggervr,
+                         const IOParameters& io_params) : 
                                vdaggerv(), momentum(), 
                                operator_lookuptable(operator_lookuptable),
                                Lt(Lt), Lx(Lx), Ly(Ly), Lz(Lz), nb_ev(nb_ev), 
                                dilE(dilE), handling_vdaggerv(handling_vdaggerv),
-                               path_vdaggerv(path_vdaggerv){
+                               path_vdaggerv(path_vdaggerv),
+                               vdaggerv_engine(vdaggerv_engine),
+                               handling_rvdaggervr(handling_rvdaggervr),
+                               io_params(io_params){
+
+  if(handling_rvdaggervr != "store" && handling_rvdaggervr != "stream"){
+    std::cout << "\n\tThe flag handling_rvdaggervr in input file is wrong!!"
+              << "\n\n" << std::endl;
+    exit(0);
+  }
 
   // resizing containers to their correct size
   vdaggerv.resize(boost::extents[
@@ -119,9 +425,13 @@ LapH::OperatorsForMesons::OperatorsForMesons
       rvdv_level2.resize(nb_rnd_combinations);
   }
 
+  // with handling_rvdaggervr = stream only the operator index is kept to 
+  // plan the lifetimes
   rvdaggervr.resize(operator_lookuptable.rvdaggervr_lookuptable.size());
   counter = 0;
   for(auto& rvdvr_level1 : rvdaggervr){
+    if(is_rvdaggervr_streamed())
+      break;
     rvdvr_level1.resize(Lt);
     size_t nb_rnd_combinations = 
         operator_lookuptable.ricQ2_lookup[
@@ -134,15 +444,17 @@ LapH::OperatorsForMesons::OperatorsForMesons
 
   // the momenta only need to be calculated for a subset of quantum numbers
   // (see VdaggerV::build_vdaggerv)
-  momentum.resize(boost::extents[
-                       operator_lookuptable.vdaggerv_lookup.size()][Lx*Ly*Lz]);
   create_momenta(Lx, Ly, Lz, operator_lookuptable.vdaggerv_lookup, momentum);
 
+  if(io_params.vdaggerv_access == "lazy")
+    unity = Eigen::MatrixXcd::Identity(nb_ev, nb_ev);
+
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::OperatorsForMesons::build_vdaggerv(const std::string& filename,
-                                              const int config) {
+                                          const std::string& filename_gauge,
+                                          const int config) {
 
   clock_t t2 = clock();
   const size_t dim_row = 3*Lx*Ly*Lz;
@@ -153,7 +465,9 @@ void LapH::OperatorsForMesons::build_vdaggerv(const std::string& filename,
   sprintf(dummy_path, "/%s/cnfg%04d/", path_vdaggerv.c_str(), config);
   const std::string full_path(dummy_path);
   // check if directory exists
-  if(handling_vdaggerv == "write" && access(full_path.c_str(), 0 ) != 0) {
+  const bool write_files = handling_vdaggerv == "write";
+  const bool write_container = handling_vdaggerv == "write_container";
+  if((write_files || write_container) && access(full_path.c_str(), 0 ) != 0) {
     std::cout << "\tdirectory " << full_path.c_str() 
               << " does not exist and will be created";
     boost::filesystem::path dir(full_path.c_str());
@@ -168,44 +482,170 @@ void LapH::OperatorsForMesons::build_vdaggerv(const std::string& filename,
   std::fill(vdaggerv.origin(), vdaggerv.origin() + vdaggerv.num_elements(), 
             Eigen::MatrixXcd::Zero(nb_ev, nb_ev));
 
+  // all operators except the unit matrix go into one file
+  std::unique_ptr<VdaggerVContainer> container;
+  if(write_container){
+    std::vector<VdaggerVQuantumNumbers> ops;
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup)
+      if(op.id != id_unity)
+        ops.push_back(op);
+    char container_name[200];
+    sprintf(container_name, "operators.%04d.vdv", config);
+    std::cout << "\twriting VdaggerV to file:" << full_path + container_name
+              << std::endl;
+    container = VdaggerVContainer::create(full_path + container_name, nb_ev, 
+                                          Lt, ops);
+  }
 
-#pragma omp parallel
-{
-  Eigen::VectorXcd mom = Eigen::VectorXcd::Zero(dim_row);
-  LapH::EigenVector V_t(1, dim_row, nb_ev);// each thread needs its own copy
-  #pragma omp for schedule(dynamic)
-  for(size_t t = 0; t < Lt; ++t){
+  // VdaggerV is independent of the gamma structure and momenta connected by
+  // sign flip are related by adjoining VdaggerV. Thus the expensive 
+  // calculation must only be performed for a subset of quantum numbers given
+  // in op_VdaggerV.
+  // For zero momentum and displacement VdaggerV is the unit matrix, thus the
+  // calculation is not performed
+  // Displaced operators are grouped by their displacement, the covariant 
+  // derivatives D_i V are computed once per direction i which occurs and 
+  // combined for each group, which is used for all its momenta
+  const std::array<int, 3> zero = {{0, 0, 0}};
+  std::vector<size_t> ids;
+  std::vector<std::array<int, 3> > momenta;
+  std::vector<std::array<int, 3> > displacements;
+  std::vector<std::vector<size_t> > displaced_ids;
+  for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+    if(op.id == id_unity)
+      continue;
+    if(op.displacement == zero){
+      ids.push_back(op.id);
+      momenta.push_back(op.momentum);
+      continue;
+    }
+    const auto it = std::find(displacements.begin(), displacements.end(), 
+                              op.displacement);
+    if(it == displacements.end()){
+      displacements.push_back(op.displacement);
+      displaced_ids.push_back({op.id});
+    }
+    else
+      displaced_ids[it - displacements.begin()].push_back(op.id);
+  }
+  std::array<bool, 3> directions = {{false, false, false}};
+  for(const auto& d : displacements)
+    for(size_t dir = 0; dir < 3; dir++)
+      directions[dir] = directions[dir] || d[dir] != 0;
+  // the eigenvectors are not needed if only the unit matrix is wanted
+  const bool need_eigenvectors = !ids.empty() || !displacements.empty();
+
+  // buffers for the displaced operators, one set per OpenMP thread which is
+  // allocated at its first timeslice
+  struct DisplacementBuffers {
+    std::unique_ptr<LapH::GaugeField> gauge;
+    std::array<Eigen::MatrixXcd, 3> DiV;
+    Eigen::MatrixXcd DV;
+  };
+  std::vector<DisplacementBuffers> displacement_buffers(
+                          displacements.empty() ? 0 : omp_get_max_threads());
+
+  // The FFT costs O(log(volume)) per site and pair of eigenvectors 
+  // independent of the number of momenta, the direct sum O(1) per momentum.
+  // The factor 4 is the measured break even point.
+  if(vdaggerv_engine != "auto" && vdaggerv_engine != "direct" &&
+     vdaggerv_engine != "fft" && vdaggerv_engine != "benchmark"){
+    std::cout << "\n\tThe flag vdaggerv_engine in input file is wrong!!\n\n"
+              << std::endl;
+    exit(0);
+  }
+  const bool use_fft = vdaggerv_engine == "fft" || 
+                       (vdaggerv_engine == "auto" && 
+                        ids.size() > 4.*std::log2(double(Lx*Ly*Lz)));
+  const bool benchmark = vdaggerv_engine == "benchmark";
+  double time_direct = 0., time_fft = 0., deviation = 0.;
+  // phase scaling and V^dagger W for every momentum
+  const double flops_direct = ids.size() * dim_row * nb_ev * (6. + 8.*nb_ev);
+  std::vector<double> gflops_direct(Lt);
+
+  auto compute_vdaggerv = [&](const size_t t, const Eigen::MatrixXcd& V_t) {
+    std::vector<Eigen::MatrixXcd*> vdv;
+    for(const auto id : ids)
+      vdv.push_back(&vdaggerv[id][t]);
+    if(benchmark){
+      std::vector<Eigen::MatrixXcd> vdv_fft(ids.size());
+      std::vector<Eigen::MatrixXcd*> vdv_fft_ptr;
+      for(auto& m : vdv_fft)
+        vdv_fft_ptr.push_back(&m);
+      const double start = omp_get_wtime();
+      vdaggerv_all_momenta(V_t, V_t, momentum, ids, vdv);
+      const double middle = omp_get_wtime();
+      vdaggerv_fft(V_t, Lx, Ly, Lz, momenta, vdv_fft_ptr);
+      const double end = omp_get_wtime();
+      double dev = 0.;
+      for(size_t i = 0; i < ids.size(); i++)
+        dev = std::max(dev, (vdv_fft[i] - *vdv[i]).norm() / vdv[i]->norm());
+      #pragma omp critical (vdaggerv_benchmark)
+      {
+        time_direct += middle - start;
+        time_fft += end - middle;
+        deviation = std::max(deviation, dev);
+      }
+      gflops_direct[t] = flops_direct / (middle - start) * 1e-9;
+    }
+    else if(use_fft)
+      vdaggerv_fft(V_t, Lx, Ly, Lz, momenta, vdv);
+    else{
+      const double start = omp_get_wtime();
+      vdaggerv_all_momenta(V_t, V_t, momentum, ids, vdv);
+      gflops_direct[t] = flops_direct / (omp_get_wtime() - start) * 1e-9;
+    }
 
-    // creating full filename for eigenvectors and reading them in
-    if(!(operator_lookuptable.vdaggerv_lookup.size() == 1 &&
-       operator_lookuptable.vdaggerv_lookup[0].id == id_unity)){
-      char inter_name[200];
-      sprintf(inter_name, "%s%03d", filename.c_str(), (int) t);
-      V_t.read_eigen_vector(inter_name, 0, 0); // reading eigenvectors
+    // displaced operators: V^dagger exp(-ipx) sum_d displacement[d] D_d V 
+    // with the symmetric covariant derivative D_d, see LapH::GaugeField
+    if(!displacements.empty()){
+      DisplacementBuffers& buf = displacement_buffers[omp_get_thread_num()];
+      if(!buf.gauge)
+        buf.gauge.reset(new LapH::GaugeField(Lt, Lx, Ly, Lz));
+      buf.gauge->read_timeslice(filename_gauge, t);
+      for(size_t dir = 0; dir < 3; dir++)
+        if(directions[dir]){
+          buf.DiV[dir].setZero(dim_row, nb_ev);
+          buf.gauge->add_derivative(dir, 1., V_t, buf.DiV[dir]);
+        }
+      for(size_t i = 0; i < displacements.size(); i++){
+        // sum_i d_i D_i V, a single derivative with d_i = 1 is used as is
+        const Eigen::MatrixXcd* DV = NULL;
+        for(size_t dir = 0; dir < 3; dir++){
+          const int d = displacements[i][dir];
+          if(d == 0)
+            continue;
+          if(DV == NULL && d == 1)
+            DV = &buf.DiV[dir];
+          else if(DV == NULL){
+            buf.DV = double(d) * buf.DiV[dir];
+            DV = &buf.DV;
+          }
+          else if(DV != &buf.DV){
+            buf.DV = *DV + double(d) * buf.DiV[dir];
+            DV = &buf.DV;
+          }
+          else
+            buf.DV += double(d) * buf.DiV[dir];
+        }
+        std::vector<Eigen::MatrixXcd*> vdv_displaced;
+        for(const auto id : displaced_ids[i])
+          vdv_displaced.push_back(&vdaggerv[id][t]);
+        vdaggerv_all_momenta(V_t, *DV, momentum, displaced_ids[i], 
+                             vdv_displaced);
+      }
     }
 
-    // VdaggerV is independent of the gamma structure and momenta connected by
-    // sign flip are related by adjoining VdaggerV. Thus the expensive 
-    // calculation must only be performed for a subset of quantum numbers given
-    // in op_VdaggerV.
     for(const auto& op : operator_lookuptable.vdaggerv_lookup){
-      // For zero momentum and displacement VdaggerV is the unit matrix, thus
-      // the calculation is not performed
       if(op.id != id_unity){
-        // momentum vector contains exp(-i p x). Divisor 3 for colour index. 
-        // All three colours on same lattice site get the same momentum.
-        for(size_t x = 0; x < dim_row; ++x) {
-          mom(x) = momentum[op.id][x/3];
-        }
-        vdaggerv[op.id][t] = V_t[0].adjoint() * mom.asDiagonal() * V_t[0];
         // writing vdaggerv to disk
-        if(handling_vdaggerv == "write"){
+        if(write_container)
+          container->write(container->find(op.momentum, op.displacement), t,
+                           vdaggerv[op.id][t]);
+        if(write_files){
           char dummy2[200];
-          sprintf(dummy2, "operators.%04d.p_", config);
-          std::string dummy = std::string(dummy2) + 
-                              std::to_string(op.momentum[0]) + 
-                              std::to_string(op.momentum[1]) + 
-                              std::to_string(op.momentum[2]);
+          sprintf(dummy2, "operators.%04d", config);
+          std::string dummy = std::string(dummy2) + vdaggerv_file_name(op);
           char outfile[200];
           sprintf(outfile, "%s_.t_%03d", dummy.c_str(), (int) t);
           write_vdaggerv(full_path, std::string(outfile), vdaggerv[op.id][t]);
@@ -214,8 +654,44 @@ void LapH::OperatorsForMesons::build_vdaggerv(const std::string& filename,
       else // zero momentum
         vdaggerv[op.id][t] = Eigen::MatrixXcd::Identity(nb_ev, nb_ev);
     }
+  };
+
+  if(io_params.vdaggerv_queue_depth > 0 && need_eigenvectors)
+    build_vdaggerv_pipelined(filename, dim_row, compute_vdaggerv);
+  else {
+#pragma omp parallel
+{
+  LapH::EigenVector V_t(1, dim_row, nb_ev);// each thread needs its own copy
+  #pragma omp for schedule(dynamic)
+  for(size_t t = 0; t < Lt; ++t){
+
+    // creating full filename for eigenvectors and reading them in
+    if(need_eigenvectors){
+      char inter_name[200];
+      sprintf(inter_name, "%s%03d", filename.c_str(), (int) t);
+      // reading eigenvectors
+      V_t.read_eigen_vector(inter_name, 0, 0, io_params);
+    }
+    compute_vdaggerv(t, V_t[0]);
   } // loop over time
 }// pragma omp parallel ends here
+  }
+
+  if(benchmark){
+    std::cout << "\tVdaggerV for " << ids.size() << " momenta: direct " 
+              << std::setprecision(3) << std::fixed << time_direct 
+              << " seconds, fft " << time_fft << " seconds, relative "
+              << "deviation " << std::scientific << deviation << std::endl;
+  }
+  if((benchmark || !use_fft) && !ids.empty()){
+    std::cout << "\tdirect VdaggerV for " << ids.size() << " momenta with "
+              << phase_scaling_isa() << " phase scaling:" 
+              << std::setprecision(1) << std::fixed;
+    for(size_t t = 0; t < Lt; ++t)
+      std::cout << (t % 8 ? " " : "\n\t\t") << "t = " << t << ": " 
+                << gflops_direct[t] << " GFLOP/s";
+    std::cout << std::endl;
+  }
 
   t2 = clock() - t2;
   std::cout << std::setprecision(1) << "\t\t\tSUCCESS - " << std::fixed 
@@ -223,6 +699,95 @@ void LapH::OperatorsForMesons::build_vdaggerv(const std::string& filename,
   is_vdaggerv_set = true;
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+/*!
+ *  @param filename Name of the eigenvectors without timeslice
+ *  @param dim_row  Length of an eigenvector
+ *  @param compute  Computes all VdaggerV for one timeslice from its 
+ *                  eigenvectors
+ *
+ *  io_params.nb_io_threads std::threads read the timeslices into a pool of 
+ *  io_params.vdaggerv_queue_depth buffers and hand them over to the OpenMP
+ *  threads, which compute and return the buffer to the pool. Thus reading 
+ *  and computing overlap and at most vdaggerv_queue_depth timeslices of 
+ *  eigenvectors are in memory. Busy and waiting times of both stages are 
+ *  printed at the end.
+ */
+void LapH::OperatorsForMesons::build_vdaggerv_pipelined(
+            const std::string& filename, const size_t dim_row,
+            const std::function<void(const size_t, 
+                                     const Eigen::MatrixXcd&)>& compute) {
+
+  const size_t depth = std::min(io_params.vdaggerv_queue_depth, Lt);
+  const size_t nb_io_threads = std::max(size_t(1), io_params.nb_io_threads);
+  LapH::EigenVector buffers(depth, dim_row, nb_ev);
+  BlockingQueue<size_t> free_buffers;
+  BlockingQueue<std::pair<size_t, size_t> > filled_buffers; // (t, buffer)
+  for(size_t b = 0; b < depth; b++)
+    free_buffers.push(b);
+
+  const double start = omp_get_wtime();
+  double read_busy = 0., read_wait = 0., compute_busy = 0., compute_wait = 0.;
+  std::mutex time_mutex;
+
+  // I/O stage
+  std::atomic<size_t> next_t(0);
+  std::vector<std::thread> readers;
+  for(size_t i = 0; i < nb_io_threads; i++)
+    readers.emplace_back([&]() {
+      double busy = 0., wait = 0.;
+      for(size_t t = next_t++; t < Lt; t = next_t++){
+        double time = omp_get_wtime();
+        const size_t b = free_buffers.pop();
+        wait += omp_get_wtime() - time;
+        time = omp_get_wtime();
+        char inter_name[200];
+        sprintf(inter_name, "%s%03d", filename.c_str(), (int) t);
+        buffers.read_eigen_vector(inter_name, b, 0, io_params);
+        busy += omp_get_wtime() - time;
+        filled_buffers.push(std::make_pair(t, b));
+      }
+      std::lock_guard<std::mutex> lock(time_mutex);
+      read_busy += busy;
+      read_wait += wait;
+    });
+
+  // compute stage
+  std::atomic<size_t> nb_claimed(0);
+#pragma omp parallel
+{
+  double busy = 0., wait = 0.;
+  while(nb_claimed++ < Lt){
+    double time = omp_get_wtime();
+    const std::pair<size_t, size_t> item = filled_buffers.pop();
+    wait += omp_get_wtime() - time;
+    time = omp_get_wtime();
+    compute(item.first, buffers[item.second]);
+    busy += omp_get_wtime() - time;
+    free_buffers.push(item.second);
+  }
+  std::lock_guard<std::mutex> lock(time_mutex);
+  compute_busy += busy;
+  compute_wait += wait;
+}// pragma omp parallel ends here
+
+  for(auto& r : readers)
+    r.join();
+
+  const double wall = omp_get_wtime() - start;
+  const size_t nb_compute_threads = omp_get_max_threads();
+  std::cout << std::setprecision(1) << std::fixed
+            << "\tVdaggerV pipeline (queue depth " << depth << "): " << wall 
+            << " seconds\n\t\tread:    " << nb_io_threads << " threads, " 
+            << 100. * read_busy / (nb_io_threads * wall) << "% busy, " 
+            << read_wait << " seconds waiting for free buffers"
+            << "\n\t\tcompute: " << nb_compute_threads << " threads, " 
+            << 100. * compute_busy / (nb_compute_threads * wall) << "% busy, "
+            << compute_wait << " seconds waiting for eigenvectors" 
+            << std::endl;
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::OperatorsForMesons::read_vdaggerv(const int config){
@@ -237,6 +802,33 @@ void LapH::OperatorsForMesons::read_vdaggerv(const int config){
                                                                 config, config);
   std::string full_path(dummy_path);
 
+  if(io_params.vdaggerv_access == "lazy"){
+    // only the mappings are created, nothing is read yet
+    vdaggerv_mappings.clear();
+    vdaggerv_views.assign(operator_lookuptable.vdaggerv_lookup.size()*Lt, 
+                          unity.data());
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+      if(op.id == id_unity)
+        continue;
+      const std::string dummy = full_path + vdaggerv_file_name(op);
+      for(size_t t = 0; t < Lt; ++t){
+        char infile[200];
+        sprintf(infile, "%s_.t_%03d", dummy.c_str(), (int) t);
+        vdaggerv_mappings.emplace_back(new MappedFile(infile));
+        if(vdaggerv_mappings.back()->size() < nb_ev*nb_ev*sizeof(cmplx)){
+          std::cout << "\n\n" << infile << " is too short\n" << std::endl;
+          exit(0);
+        }
+        vdaggerv_views[op.id*Lt + t] = reinterpret_cast<const cmplx*>(
+                                            vdaggerv_mappings.back()->data());
+      }
+    }
+    std::cout << "\tmapped " << vdaggerv_mappings.size() 
+              << " VdaggerV files:" << full_path << std::endl;
+    is_vdaggerv_set = true;
+    return;
+  }
+
   // resizing each matrix in vdaggerv
   std::fill(vdaggerv.origin(), vdaggerv.origin() + vdaggerv.num_elements(), 
             Eigen::MatrixXcd::Zero(nb_ev, nb_ev));
@@ -251,14 +843,21 @@ void LapH::OperatorsForMesons::read_vdaggerv(const int config){
       if(op.id != id_unity){
 
         // creating full filename for vdaggerv and reading them in
-        std::string dummy = full_path + ".p_" + 
-                            std::to_string(op.momentum[0]) + 
-                            std::to_string(op.momentum[1]) + 
-                            std::to_string(op.momentum[2]);
+        std::string dummy = full_path + vdaggerv_file_name(op);
 
         char infile[200];
         sprintf(infile, "%s_.t_%03d", dummy.c_str(), (int) t);
 
+        // the files are column major, thus they can be read in place
+        if(io_params.io_backend != "stdio"){
+          std::cout << "\treading VdaggerV from file:" << infile << std::endl;
+          BinaryReader file(infile, io_params);
+          file.queue(vdaggerv[op.id][t].data(), 
+                     vdaggerv[op.id][t].size()*sizeof(cmplx), 0);
+          file.wait();
+          continue;
+        }
+
         // writing the data
         std::ifstream file(infile, std::ifstream::binary);
       
@@ -298,6 +897,97 @@ void LapH::OperatorsForMesons::read_vdaggerv(const int config){
   is_vdaggerv_set = true;
 }
 
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+/*!
+ *  @param config The configuration number
+ *
+ *  Reads the file written with handling_vdaggerv = write_container. Every
+ *  matrix is a single positioned read at the offset stored in the header. 
+ *  With io_backend pread or io_uring all reads are queued at once.
+ *
+ *  With vdaggerv_access = lazy the file is only mapped. Readahead is switched
+ *  off, thus only the timeslices which are used are paged in.
+ */
+void LapH::OperatorsForMesons::read_vdaggerv_container(const int config){
+
+  clock_t t2 = clock();
+  const int id_unity = operator_lookuptable.index_of_unity;
+
+  char infile[200];
+  sprintf(infile, "/%s/cnfg%04d/operators.%04d.vdv", path_vdaggerv.c_str(), 
+                                                                config, config);
+  std::cout << "\treading VdaggerV from file:" << infile << std::endl;
+  const bool lazy = io_params.vdaggerv_access == "lazy";
+  vdaggerv_container.reset();
+  std::unique_ptr<VdaggerVContainer> container = 
+                                          VdaggerVContainer::open(infile, lazy);
+  if(container->get_nb_ev() != nb_ev || container->get_Lt() != Lt){
+    std::cout << "\n\n" << infile << " contains VdaggerV for " 
+              << container->get_nb_ev() << " eigenvectors and " 
+              << container->get_Lt() << " timeslices\n" << std::endl;
+    exit(0);
+  }
+
+  // position of every operator in the file
+  std::vector<int> index(operator_lookuptable.vdaggerv_lookup.size(), -1);
+  for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+    if(op.id == id_unity)
+      continue;
+    index[op.id] = container->find(op.momentum, op.displacement);
+    if(index[op.id] == -1){
+      std::cout << "\n\n" << infile << " does not contain VdaggerV for p = (" 
+                << op.momentum[0] << "," << op.momentum[1] << "," 
+                << op.momentum[2] << ")\n" << std::endl;
+      exit(0);
+    }
+  }
+
+  if(lazy){
+    container->get_mapping()->advise(MADV_RANDOM);
+    vdaggerv_views.assign(operator_lookuptable.vdaggerv_lookup.size()*Lt, 
+                          unity.data());
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup)
+      if(op.id != id_unity)
+        for(size_t t = 0; t < Lt; ++t)
+          vdaggerv_views[op.id*Lt + t] = 
+                                     container->view(index[op.id], t).data();
+    vdaggerv_container = std::move(container);
+    is_vdaggerv_set = true;
+    return;
+  }
+
+  // resizing each matrix in vdaggerv
+  std::fill(vdaggerv.origin(), vdaggerv.origin() + vdaggerv.num_elements(), 
+            Eigen::MatrixXcd::Zero(nb_ev, nb_ev));
+
+  if(io_params.io_backend != "stdio"){
+    BinaryReader file(infile, io_params);
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup)
+      if(op.id != id_unity)
+        for(size_t t = 0; t < Lt; ++t)
+          file.queue(vdaggerv[op.id][t].data(), container->matrix_size(),
+                     container->offset(index[op.id], t));
+    file.wait();
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for(size_t t = 0; t < Lt; ++t){
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+      // For zero momentum and displacement VdaggerV is the unit matrix
+      if(op.id == id_unity)
+        vdaggerv[op.id][t] = Eigen::MatrixXcd::Identity(nb_ev, nb_ev);
+      else if(io_params.io_backend == "stdio")
+        container->read(index[op.id], t, vdaggerv[op.id][t]);
+    }
+  } // loop over time
+
+  t2 = clock() - t2;
+  std::cout << std::setprecision(1) << "\t\t\tSUCCESS - " << std::fixed 
+    << ((float) t2)/CLOCKS_PER_SEC << " seconds" << std::endl;
+  is_vdaggerv_set = true;
+}
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::OperatorsForMesons::read_vdaggerv_liuming(const int config){
@@ -306,6 +996,14 @@ void LapH::OperatorsForMesons::read_vdaggerv_liuming(const int config){
   const size_t dim_row = 3*Lx*Ly*Lz;
   const int id_unity = operator_lookuptable.index_of_unity;
 
+  // the format has no displacement
+  for(const auto& op : operator_lookuptable.vdaggerv_lookup)
+    if(op.displacement != std::array<int, 3>({{0, 0, 0}})){
+      std::cout << "\n\tDisplaced operators cannot be read with "
+                << "handling_vdaggerv = liuming!!\n\n" << std::endl;
+      exit(0);
+    }
+
   // prepare full path for reading
   char dummy_path[200];
   sprintf(dummy_path, "/%s/VdaggerV.", path_vdaggerv.c_str());
@@ -434,23 +1132,29 @@ void LapH::OperatorsForMesons::build_rvdaggerv(
   // numbers with random vectors from the left.
   for(const auto& op : operator_lookuptable.rvdaggerv_lookuptable){
 
-    Eigen::MatrixXcd vdv;
-    if(op.need_vdaggerv_daggering == false)
-      vdv = vdaggerv[op.id_vdaggerv][t];
-    else
-      vdv = vdaggerv[op.id_vdaggerv][t].adjoint();
+    // -p is obtained from the stored p by adjoining, the adjoint is only a
+    // view and not copied
+    const auto vdv = return_vdaggerv(op.id_vdaggerv, t);
+    const bool dagger = op.need_vdaggerv_daggering;
+    const bool unity = is_vdaggerv_unity(op.id_vdaggerv);
 
     size_t rid = 0;
     for(const auto& rnd_id : 
               operator_lookuptable.ricQ1_lookup[op.id_ricQ_lookup].rnd_vec_ids){
 
       for(size_t block = 0; block < 4; block++){
-      for(size_t vec_i = 0; vec_i < nb_ev; ++vec_i) {
-        size_t blk =  block + vec_i * 4 + 4 * nb_ev * t;
-        
-        rvdaggerv[op.id][t][rid].block(vec_i%dilE + dilE*block, 0, 1, nb_ev) += 
-             vdv.row(vec_i) * std::conj(rnd_vec(rnd_id, blk));
-      }}
+        const Eigen::VectorXcd rnd = dirac_block_entries(rnd_vec, rnd_id, t, 
+                                                   block, nb_ev).conjugate();
+        if(unity)
+          add_diluted_unity_rows(rnd, dilE, dilE*block, 
+                                 rvdaggerv[op.id][t][rid]);
+        else if(!dagger)
+          add_diluted_rows(vdv, rnd, dilE, dilE*block, 
+                           rvdaggerv[op.id][t][rid]);
+        else
+          add_diluted_rows(vdv.adjoint(), rnd, dilE, dilE*block, 
+                           rvdaggerv[op.id][t][rid]);
+      }
       rid++;
     }
   }}// time and operator loops end here
@@ -474,56 +1178,87 @@ void LapH::OperatorsForMesons::build_rvdaggervr(
   clock_t t2 = clock();
   std::cout << "\tbuild rvdaggervr:";
 
-  for(auto& rvdvr_level1 : rvdaggervr)
-    for(auto& rvdvr_level2 : rvdvr_level1)
-      for(auto& rvdvr_level3 : rvdvr_level2)
-        rvdvr_level3 = Eigen::MatrixXcd::Zero(4*dilE, 4*dilE);
-
 #pragma omp parallel for schedule(dynamic)
   for(size_t t = 0; t < Lt; t++){
+    for(const auto& op : operator_lookuptable.rvdaggervr_lookuptable)
+      build_rvdaggervr_one_t(op.id, t, rvdaggervr[op.id][t]);
+  }
 
-  // rvdaggervr is calculated by multiplying vdaggerv with the same quantum
-  // numbers with random vectors from right and left.
-  for(const auto& op : operator_lookuptable.rvdaggervr_lookuptable){
+  t2 = clock() - t2;
+  std::cout << std::setprecision(1) << "\t\tSUCCESS - " << std::fixed 
+    << ((float) t2)/CLOCKS_PER_SEC << " seconds" << std::endl;
+}
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+/*!
+ *  @param index Index of the operator in rvdaggervr_lookuptable
+ *  @param t     Timeslice
+ *  @param rvdvr Resized to the number of random vector combinations of the 
+ *               operator, receives one 4*dilE x 4*dilE matrix for each
+ */
+void LapH::OperatorsForMesons::build_rvdaggervr_one_t(const size_t index, 
+                          const size_t t, 
+                          std::vector<Eigen::MatrixXcd>& rvdvr) const {
 
-    Eigen::MatrixXcd vdv;
-    if(op.need_vdaggerv_daggering == false)
-      vdv = vdaggerv[op.id_vdaggerv][t];
-    else
-      vdv = vdaggerv[op.id_vdaggerv][t].adjoint();
+  const auto& op = operator_lookuptable.rvdaggervr_lookuptable[index];
+  const auto& rnd_vec_ids = 
+                operator_lookuptable.ricQ2_lookup[op.id_ricQ_lookup].rnd_vec_ids;
+  rvdvr.resize(rnd_vec_ids.size());
+  for(auto& r : rvdvr)
+    r = Eigen::MatrixXcd::Zero(4*dilE, 4*dilE);
 
-    size_t rid = 0;
-    int check = -1;
-    Eigen::MatrixXcd M; // Intermediate memory
-    for(const auto& rnd_id : 
-              operator_lookuptable.ricQ2_lookup[op.id_ricQ_lookup].rnd_vec_ids){
-
-      if(check != rnd_id.first){ // this avoids recomputation
-        M = Eigen::MatrixXcd::Zero(nb_ev, 4*dilE);
-        for(size_t block = 0; block < 4; block++){
-        for(size_t vec_i = 0; vec_i < nb_ev; vec_i++) {
-          size_t blk =  block + (vec_i + nb_ev * t) * 4;
-          M.block(0, vec_i%dilE + dilE*block, nb_ev, 1) += 
-               vdv.col(vec_i) * rnd_vec(rnd_id.first, blk);
-        }}
-      }
+  // rvdaggervr is calculated by multiplying vdaggerv with the same quantum
+  // numbers with random vectors from right and left.
+  // see build_rvdaggerv()
+  const auto vdv = return_vdaggerv(op.id_vdaggerv, t);
+  const bool dagger = op.need_vdaggerv_daggering;
+  const bool unity = is_vdaggerv_unity(op.id_vdaggerv);
+
+  // V^dagger exp(ipx) V P rho for every random vector on the right, it is
+  // shared by all combinations with the same rnd_id.first
+  std::map<size_t, Eigen::MatrixXcd> M;
+  size_t rid = 0;
+  for(const auto& rnd_id : rnd_vec_ids){
+
+    // For the unit matrix only the diagonal of each dilution block gets 
+    // contributions, it is the product of the two random vectors
+    if(unity){
       for(size_t block_x = 0; block_x < 4; block_x++){
-      for(size_t block_y = 0; block_y < 4; block_y++){
-      for(size_t vec_y = 0; vec_y < nb_ev; ++vec_y) {
-        size_t blk =  block_y + (vec_y + nb_ev * t) * 4;
-        rvdaggervr[op.id][t][rid].block(
-                            dilE*block_y + vec_y%dilE, dilE*block_x, 1, dilE) +=
-                M.block(vec_y, dilE*block_x, 1, dilE) * 
-                std::conj(rnd_vec(rnd_id.second, blk));
-      }}} 
-      check = rnd_id.first;
+        const Eigen::VectorXcd rnd_x = 
+                dirac_block_entries(*rnd_vec, rnd_id.first, t, block_x, nb_ev);
+        for(size_t block_y = 0; block_y < 4; block_y++){
+          const Eigen::VectorXcd rnd_y = dirac_block_entries(*rnd_vec, 
+                              rnd_id.second, t, block_y, nb_ev).conjugate();
+          for(size_t vec_i = 0; vec_i < nb_ev; vec_i++)
+            rvdvr[rid](dilE*block_y + vec_i%dilE, 
+                       dilE*block_x + vec_i%dilE) += rnd_y(vec_i) * rnd_x(vec_i);
+        }
+      }
       rid++;
+      continue;
     }
-  }}// time and operator loops end here
 
-  t2 = clock() - t2;
-  std::cout << std::setprecision(1) << "\t\tSUCCESS - " << std::fixed 
-    << ((float) t2)/CLOCKS_PER_SEC << " seconds" << std::endl;
+    auto M_it = M.find(rnd_id.first);
+    if(M_it == M.end()){
+      M_it = M.insert(std::make_pair(rnd_id.first, 
+                              Eigen::MatrixXcd::Zero(nb_ev, 4*dilE))).first;
+      for(size_t block = 0; block < 4; block++){
+        const Eigen::VectorXcd rnd = 
+                  dirac_block_entries(*rnd_vec, rnd_id.first, t, block, nb_ev);
+        if(!dagger)
+          add_diluted_cols(vdv, rnd, dilE, dilE*block, M_it->second);
+        else
+          add_diluted_cols(vdv.adjoint(), rnd, dilE, dilE*block, 
+                           M_it->second);
+      }
+    }
+    for(size_t block = 0; block < 4; block++){
+      const Eigen::VectorXcd rnd = dirac_block_entries(*rnd_vec, 
+                                rnd_id.second, t, block, nb_ev).conjugate();
+      add_diluted_rows(M_it->second, rnd, dilE, dilE*block, rvdvr[rid]);
+    }
+    rid++;
+  }
 }
 
 // ------------------------ INTERFACE ------------------------------------------
@@ -531,24 +1266,44 @@ void LapH::OperatorsForMesons::build_rvdaggervr(
 
 /*! 
  *  @param filename The name to write to / read from the V^\dagger V operators
+ *  @param filename_gauge The name of the gauge configuration, only read if 
+ *                  VdaggerV of displaced operators is built
  *  @param rnd_vec  The random vector
  *  @param config   The configuration number to be read. Unused if 
  *                  handling_vdaggerv is "build" or "write"
  *
  *  Behavior of this function depends on handling_vdaggerv flag.
  *  - "read" | "liuming" The operators are read in the corresponding format.
+ *  - "read_container"   The operators are read from a single file per 
+ *                       configuration
  *  - "build"            The operators are constructed from the eigenvectors
  *  - "write"            The operators are constructed and additionaly written 
  *                       out.
+ *  - "write_container"  As "write", but into a single file per configuration
+ *
+ *  With handling_rvdaggervr = stream rVdaggerVr is not built here, rnd_vec is
+ *  then read by the diagrams and must live until the last of them is done.
  */
 void LapH::OperatorsForMesons::create_operators(const std::string& filename, 
+                                            const std::string& filename_gauge,
                                             const LapH::RandomVector& rnd_vec,
                                             const int config) {
   is_vdaggerv_set = false;
-  if(handling_vdaggerv == "write" || handling_vdaggerv == "build")
-    build_vdaggerv(filename, config);
+  if(io_params.vdaggerv_access != "eager" && 
+     !(io_params.vdaggerv_access == "lazy" && (handling_vdaggerv == "read" ||
+                                      handling_vdaggerv == "read_container"))){
+    std::cout << "\n\tThe flag vdaggerv_access in input file is wrong or not "
+              << "possible with handling_vdaggerv = " << handling_vdaggerv 
+              << "!!\n\n" << std::endl;
+    exit(0);
+  }
+  if(handling_vdaggerv == "write" || handling_vdaggerv == "build" ||
+     handling_vdaggerv == "write_container")
+    build_vdaggerv(filename, filename_gauge, config);
   else if(handling_vdaggerv == "read")
     read_vdaggerv(config);
+  else if(handling_vdaggerv == "read_container")
+    read_vdaggerv_container(config);
   else if(handling_vdaggerv == "liuming")
     read_vdaggerv_liuming(config);
   else{
@@ -556,8 +1311,89 @@ void LapH::OperatorsForMesons::create_operators(const std::string& filename,
               << std::endl;
     exit(0);
   }
+  this->rnd_vec = &rnd_vec;
   build_rvdaggerv(rnd_vec);
-  build_rvdaggervr(rnd_vec);
+  if(!is_rvdaggervr_streamed())
+    build_rvdaggervr(rnd_vec);
+}
+
+/******************************************************************************/
+/*!
+ *  @param filename The name of the eigenvectors without timeslice
+ *  @param filename_gauge The name of the gauge configuration
+ *  @param config   The configuration number
+ *
+ *  Issues a readahead for all files create_operators() will read for config:
+ *  the eigenvectors and, for displaced operators, the gauge configuration 
+ *  for "build", "write" and "write_container", the VdaggerV 
+ *  files for "read", "read_container" and "liuming". The call returns 
+ *  immediately, the kernel fills the page cache in the background and no 
+ *  memory of the process is used.
+ *
+ *  This is the whole prefetch of the operator input: unlike the 
+ *  perambulators there is no second buffer, create_operators() still reads 
+ *  and processes the files in the foreground and only finds them in the 
+ *  page cache if the kernel did not evict them in the meantime.
+ */
+void LapH::OperatorsForMesons::prefetch_input(const std::string& filename,
+                                           const std::string& filename_gauge,
+                                           const int config) const {
+  const int id_unity = operator_lookuptable.index_of_unity;
+  if(handling_vdaggerv == "write" || handling_vdaggerv == "build" ||
+     handling_vdaggerv == "write_container"){
+    if(operator_lookuptable.vdaggerv_lookup.size() == 1 &&
+       operator_lookuptable.vdaggerv_lookup[0].id == id_unity)
+      return;
+    for(size_t t = 0; t < Lt; ++t){
+      char inter_name[200];
+      sprintf(inter_name, "%s%03d", filename.c_str(), (int) t);
+      readahead_file(inter_name);
+    }
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup)
+      if(op.displacement != std::array<int, 3>({{0, 0, 0}})){
+        readahead_file(filename_gauge);
+        break;
+      }
+  }
+  else if(handling_vdaggerv == "read"){
+    char dummy_path[200];
+    sprintf(dummy_path, "/%s/cnfg%04d/operators.%04d", path_vdaggerv.c_str(), 
+                                                                config, config);
+    const std::string full_path(dummy_path);
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+      if(op.id == id_unity)
+        continue;
+      const std::string dummy = full_path + vdaggerv_file_name(op);
+      for(size_t t = 0; t < Lt; ++t){
+        char infile[200];
+        sprintf(infile, "%s_.t_%03d", dummy.c_str(), (int) t);
+        readahead_file(infile);
+      }
+    }
+  }
+  else if(handling_vdaggerv == "read_container"){
+    char infile[200];
+    sprintf(infile, "/%s/cnfg%04d/operators.%04d.vdv", path_vdaggerv.c_str(), 
+                                                                config, config);
+    readahead_file(infile);
+  }
+  else if(handling_vdaggerv == "liuming"){
+    const std::string full_path = "/" + path_vdaggerv + "/VdaggerV.";
+    for(const auto& op : operator_lookuptable.vdaggerv_lookup){
+      if(op.id == id_unity)
+        continue;
+      // both possibilities for the name are tried
+      for(const int sign : {-1, 1}){
+        const std::string dummy = full_path + "p" + 
+                                  std::to_string(sign*op.momentum[0]) + "p" +
+                                  std::to_string(sign*op.momentum[1]) + "p" +
+                                  std::to_string(sign*op.momentum[2]) + ".conf";
+        char infile[200];
+        sprintf(infile, "%s%04d", dummy.c_str(), config);
+        readahead_file(infile);
+      }
+    }
+  }
 }
 
 /******************************************************************************/
@@ -578,23 +1414,122 @@ void LapH::OperatorsForMesons::create_operators(const std::string& filename,
  *  E.g. after building Quarkline Q2, vdaggerv is no longer needed and can be 
  *  deleted to free up space
  *
- *  Resizes vdaggerv to 0
+ *  Resizes vdaggerv to 0 and releases the mappings of vdaggerv_access = lazy
  */
 void LapH::OperatorsForMesons::free_memory_vdaggerv(){
+  vdaggerv_views.clear();
+  vdaggerv_mappings.clear();
+  vdaggerv_container.reset();
   std::for_each(vdaggerv.origin(), vdaggerv.origin() + vdaggerv.num_elements(), 
-                [](Eigen::MatrixXcd m){m.resize(0, 0);});
+                [](Eigen::MatrixXcd& m){m.resize(0, 0);});
 }
 
+/******************************************************************************/
+/*!
+ *  @param usage Operators read by each stage
+ *
+ *  For every operator the last stage reading it is stored. Operators which 
+ *  are only needed within create_operators() get -1 and are freed with the 
+ *  first call of release_operators(). With handling_rvdaggervr = stream a 
+ *  stage reading rVdaggerVr reads the underlying VdaggerV instead.
+ */
+void LapH::OperatorsForMesons::plan_operator_lifetimes(
+                                     const std::vector<OperatorUsage>& usage) {
+  stages.clear();
+  last_use_vdaggerv.assign(vdaggerv.shape()[0], -1);
+  last_use_rvdaggerv.assign(rvdaggerv.size(), -1);
+  last_use_rvdaggervr.assign(rvdaggervr.size(), -1);
+  for(const auto& u : usage){
+    for(const auto id : u.vdaggerv)
+      last_use_vdaggerv.at(id) = stages.size();
+    for(const auto id : u.rvdaggerv)
+      last_use_rvdaggerv.at(id) = stages.size();
+    for(const auto id : u.rvdaggervr){
+      last_use_rvdaggervr.at(id) = stages.size();
+      if(is_rvdaggervr_streamed())
+        last_use_vdaggerv.at(operator_lookuptable.rvdaggervr_lookuptable[id].
+                                                  id_vdaggerv) = stages.size();
+    }
+    stages.push_back(u.stage);
+  }
+}
 
+/******************************************************************************/
+/*!
+ *  @param stage Name of the stage which just finished
+ *
+ *  Does nothing if plan_operator_lifetimes() was not called or does not know 
+ *  stage. With vdaggerv_access = lazy VdaggerV lives in the page cache and is
+ *  not freed here.
+ */
+void LapH::OperatorsForMesons::release_operators(const std::string& stage) {
+  const auto it = std::find(stages.begin(), stages.end(), stage);
+  if(it == stages.end())
+    return;
+  const int index = it - stages.begin();
+  const size_t before = memory_usage();
+
+  for(size_t id = 0; id < last_use_vdaggerv.size(); id++)
+    if(last_use_vdaggerv[id] <= index)
+      for(size_t t = 0; t < Lt; t++)
+        vdaggerv[id][t].resize(0, 0);
+  for(size_t id = 0; id < last_use_rvdaggerv.size(); id++)
+    if(last_use_rvdaggerv[id] <= index)
+      for(auto& rvdv_level2 : rvdaggerv[id])
+        for(auto& rvdv_level3 : rvdv_level2)
+          rvdv_level3.resize(0, 0);
+  for(size_t id = 0; id < last_use_rvdaggervr.size(); id++)
+    if(last_use_rvdaggervr[id] <= index)
+      for(auto& rvdvr_level2 : rvdaggervr[id])
+        for(auto& rvdvr_level3 : rvdvr_level2)
+          rvdvr_level3.resize(0, 0);
+
+  std::cout << std::setprecision(1) << std::fixed 
+            << "\toperator memory during " << stage << ": " 
+            << before/1024./1024. << " MB, afterwards: " 
+            << memory_usage()/1024./1024. << " MB" << std::endl;
+}
 
+/******************************************************************************/
+size_t LapH::OperatorsForMesons::memory_usage() const {
+  size_t elements = 0;
+  std::for_each(vdaggerv.origin(), vdaggerv.origin() + vdaggerv.num_elements(),
+                [&](const Eigen::MatrixXcd& m){elements += m.size();});
+  for(const auto& rvdv_level1 : rvdaggerv)
+    for(const auto& rvdv_level2 : rvdv_level1)
+      for(const auto& rvdv_level3 : rvdv_level2)
+        elements += rvdv_level3.size();
+  for(const auto& rvdvr_level1 : rvdaggervr)
+    for(const auto& rvdvr_level2 : rvdvr_level1)
+      for(const auto& rvdvr_level3 : rvdvr_level2)
+        elements += rvdvr_level3.size();
+  return elements * sizeof(cmplx);
+}
 
+/******************************************************************************/
+/******************************************************************************/
+void LapH::RVdaggerVRBuffer::set_blocks(const size_t t1_i, const size_t t2_i){
+  for(auto it = rvdaggervr.begin(); it != rvdaggervr.end();){
+    const size_t t_i = it->first.second / dilT;
+    if(t_i != t1_i && t_i != t2_i)
+      it = rvdaggervr.erase(it);
+    else
+      ++it;
+  }
+}
 
-
-
-
-
-
-
-
-
-
+/******************************************************************************/
+const Eigen::MatrixXcd& LapH::RVdaggerVRBuffer::return_rvdaggervr(
+                 const size_t index, const size_t t, const size_t rnd_id) {
+  if(!meson_operator.is_rvdaggervr_streamed())
+    return meson_operator.return_rvdaggervr(index, t, rnd_id);
+
+  const auto key = std::make_pair(index, t);
+  auto it = rvdaggervr.find(key);
+  if(it == rvdaggervr.end()){
+    it = rvdaggervr.insert(std::make_pair(key, 
+                                      std::vector<Eigen::MatrixXcd>())).first;
+    meson_operator.build_rvdaggervr_one_t(index, t, it->second);
+  }
+  return it->second.at(rnd_id);
+}
@@ -1,5 +1,122 @@
 #include "Perambulator.h"
 
+#include <sys/mman.h>
+
+#include <atomic>
+#include <thread>
+
+#include "omp.h"
+
+#include "BinaryReader.h"
+#include "MappedFile.h"
+
+namespace {
+
+/*! Edge length of the square tiles in which the reordering is done. 64x64 
+ *  complex doubles for source and destination fit into L2 cache.
+ */
+const size_t reorder_block = 64;
+
+/******************************************************************************/
+/*! Scatters the rows [row_begin, row_end) of a perambulator as stored on disk
+ *  into the Eigen matrix
+ *
+ *  @tparam Src      Complex type of the file
+ *  @tparam Matrix   Eigen matrix type of the perambulator, the precision is
+ *                   converted if it differs from Src
+ *  @param src       Points to row row_begin of the perambulator on disk
+ *  @param row_begin First row on disk contained in src
+ *  @param row_end   One past the last row on disk contained in src
+ *  @param nb_eigen_vec Total number of eigen vecs
+ *  @param quark     Contains information about dilution scheme and size
+ *  @param peram     Matrix the data is written to
+ *
+ *  The same mapping as in LapH::Perambulator::read_perambulator() is used, 
+ *  i.e. row_i = (t1, ev1, dirac1) -> (t1, dirac1, ev1) and 
+ *  col_i = (t2, ev2, dirac2) -> (t2, dirac2, ev2). The index maps are computed
+ *  once and the copy is done tile by tile, the tiles are distributed over the
+ *  OpenMP threads.
+ */
+template <typename Src, typename Matrix>
+void reorder_perambulator(const Src* src, const size_t row_begin, 
+                          const size_t row_end, const size_t nb_eigen_vec,
+                          const quark& quark, Matrix& peram) {
+  typedef typename Matrix::Scalar Dest;
+
+  const size_t nb_dil_E = quark.number_of_dilution_E;
+  const size_t nb_dil_D = quark.number_of_dilution_D;
+  const size_t nb_cols = peram.cols();
+  const size_t nb_rows = row_end - row_begin;
+
+  std::vector<size_t> dest_row(nb_rows), dest_col(nb_cols);
+  for(size_t row_i = row_begin; row_i < row_end; ++row_i){
+    const size_t t1 = row_i / (4 * nb_eigen_vec);
+    const size_t ev1 = (row_i % (4 * nb_eigen_vec)) / 4;
+    const size_t dirac1 = row_i % 4;
+    dest_row[row_i - row_begin] = 
+                           4 * nb_eigen_vec * t1 + nb_eigen_vec * dirac1 + ev1;
+  }
+  for(size_t col_i = 0; col_i < nb_cols; ++col_i){
+    const size_t t2 = col_i / (nb_dil_D * nb_dil_E);
+    const size_t ev2 = (col_i % (nb_dil_D * nb_dil_E)) / nb_dil_D;
+    const size_t dirac2 = col_i % nb_dil_D;
+    dest_col[col_i] = nb_dil_E * nb_dil_D * t2 + nb_dil_E * dirac2 + ev2;
+  }
+
+  const size_t nb_row_blocks = (nb_rows + reorder_block - 1) / reorder_block;
+  const size_t nb_col_blocks = (nb_cols + reorder_block - 1) / reorder_block;
+  Dest* dest = peram.data();
+  const size_t ld = peram.rows();
+
+  #pragma omp parallel for collapse(2) schedule(static)
+  for(size_t rb = 0; rb < nb_row_blocks; ++rb){
+    for(size_t cb = 0; cb < nb_col_blocks; ++cb){
+      const size_t r1 = std::min(nb_rows, (rb + 1) * reorder_block);
+      const size_t c1 = std::min(nb_cols, (cb + 1) * reorder_block);
+      for(size_t c = cb * reorder_block; c < c1; ++c){
+        Dest* dest_c = dest + dest_col[c] * ld;
+        for(size_t r = rb * reorder_block; r < r1; ++r)
+          dest_c[dest_row[r]] = Dest(src[r * nb_cols + c]);
+      }
+    }
+  }
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+/*!
+ *  @param src         Points to row row_begin of the perambulator on disk
+ *  @param single_file The file contains std::complex<float>
+ *
+ *  Dispatches reorder_perambulator() for the precision of the file and of the
+ *  storage.
+ */
+void LapH::Perambulator::reorder(const char* src, const size_t row_begin, 
+                                 const size_t row_end, 
+                                 const size_t nb_eigen_vec, const quark& quark,
+                                 const size_t entity, 
+                                 const bool single_file) {
+  if(single_file){
+    const cmplxf* s = reinterpret_cast<const cmplxf*>(src);
+    if(is_single_precision())
+      reorder_perambulator(s, row_begin, row_end, nb_eigen_vec, quark,
+                           peram_sp[entity]);
+    else
+      reorder_perambulator(s, row_begin, row_end, nb_eigen_vec, quark,
+                           peram[entity]);
+  }
+  else{
+    const cmplx* s = reinterpret_cast<const cmplx*>(src);
+    if(is_single_precision())
+      reorder_perambulator(s, row_begin, row_end, nb_eigen_vec, quark,
+                           peram_sp[entity]);
+    else
+      reorder_perambulator(s, row_begin, row_end, nb_eigen_vec, quark,
+                           peram[entity]);
+  }
+}
+
 /******************************************************************************/
 /*!
  *  @param entity       The entry where this peram will be stored
@@ -7,61 +124,175 @@
  *  @param nb_eigen_vec Total number of eigen vecs - for each peram the same
  *  @param quark        Contains information about dilution scheme and size
  *  @param filename     Just the file name
+ *  @param io_params    io_backend decides if fread or LapH::BinaryReader is 
+ *                      used, perambulator_file_precision gives the precision 
+ *                      of the file
  */
 void LapH::Perambulator::read_perambulator(const size_t entity, 
                                            const size_t Lt,
                                            const size_t nb_eigen_vec,
                                            const quark& quark,
-                                           const std::string& filename) {
-  clock_t t = clock();
+                                           const std::string& filename,
+                                           const IOParameters& io_params) {
+  const double t = omp_get_wtime();
   FILE *fp = NULL;
-
-  std::cout << "\tReading perambulator from file:\n\t\t" << filename;
+  const bool single_file = io_params.perambulator_file_precision == "single";
+  const size_t nb_bytes = rows(entity) * cols(entity) * 
+                          (single_file ? sizeof(cmplxf) : sizeof(cmplx));
 
   // reading the data into temporary array
-  vec perambulator_read(peram[entity].size());
-  if((fp = fopen(filename.c_str(), "rb")) == NULL){
-    std::cout << "failed to open file to read perambulaots: " 
-              << filename << "\n" << std::endl;
-    exit(0);
+  DirectBuffer perambulator_read(nb_bytes);
+  if(io_params.io_backend != "stdio"){
+    BinaryReader file(filename, io_params);
+    file.queue(&(perambulator_read[0]), nb_bytes, 0);
+    file.wait();
   }
-  int check_read = fread(&(perambulator_read[0]), sizeof(cmplx),
-                                                      peram[entity].size(), fp);
-  fclose(fp);
-  // check if all data were read in
-  if(check_read != peram[entity].size()){
-    std::cout << "\n\nFailed to read perambulator\n" << std::endl;
-    exit(0);
+  else{
+    if((fp = fopen(filename.c_str(), "rb")) == NULL){
+      std::cout << "failed to open file to read perambulaots: " 
+                << filename << "\n" << std::endl;
+      exit(0);
+    }
+    size_t check_read = fread(&(perambulator_read[0]), 1, nb_bytes, fp);
+    fclose(fp);
+    // check if all data were read in
+    if(check_read != nb_bytes){
+      std::cout << "\n\nFailed to read perambulator\n" << std::endl;
+      exit(0);
+    }
   }
-  
-  // setting peram to zero
-  peram[entity].setZero();
 
   // re-sorting and copy into matrix structure 
   // TODO: At this point it is very easy to included different dilution schemes.
   //       However, due to simplicity this will be postponed!
-  const size_t nb_dil_T = quark.number_of_dilution_T;
-  const size_t nb_dil_E = quark.number_of_dilution_E;
-  const size_t nb_dil_D = quark.number_of_dilution_D;
-  size_t col_i, row_i;
-  const int nb_inversions = Lt * nb_dil_E * nb_dil_D / nb_dil_T;
-  for(size_t t1 = 0; t1 < Lt; ++t1)
-    for(size_t ev1 = 0; ev1 < nb_eigen_vec; ++ev1)
-      for(size_t dirac1 = 0; dirac1 < 4; ++dirac1)
-        for(size_t t2 = 0; t2 < (Lt / nb_dil_T); ++t2)
-          for(size_t ev2 = 0; ev2 < nb_dil_E; ++ev2)
-            for(size_t dirac2 = 0; dirac2 < nb_dil_D; ++dirac2){
-              row_i = 4 * nb_eigen_vec * t1 + 4 * ev1 + dirac1;
-              col_i = nb_dil_D * nb_dil_E * t2 + nb_dil_D * ev2 + dirac2;
-              peram[entity](4 * nb_eigen_vec * t1 + nb_eigen_vec * dirac1 + ev1,
-                    nb_dil_E * nb_dil_D * t2 + nb_dil_E * dirac2 + ev2) = 
-                               perambulator_read[row_i * nb_inversions + col_i];
-            }
+  reorder(&(perambulator_read[0]), 0, rows(entity), nb_eigen_vec, quark, 
+          entity, single_file);
+
+  // writing out how long it took to read the file
+  #pragma omp critical (cout)
+  std::cout << "\tReading perambulator from file:\n\t\t" << filename 
+            << "\n\t\tin: " << std::fixed << std::setprecision(1)
+            << omp_get_wtime() - t << " seconds" << std::endl;
+}
+
+/******************************************************************************/
+/*!
+ *  @param entity       The entry where this peram will be stored
+ *  @param Lt           Total number of timeslices - for each peram the same
+ *  @param nb_eigen_vec Total number of eigen vecs - for each peram the same
+ *  @param quark        Contains information about dilution scheme and size
+ *  @param filename     Just the file name
+ *  @param single_file  The file contains single precision numbers
+ *
+ *  In contrast to read_perambulator() the file is not copied into a temporary
+ *  array. The page cache is accessed directly and the reordering is done by
+ *  all OpenMP threads. The time given is wall clock time.
+ */
+void LapH::Perambulator::read_perambulator_mmap(const size_t entity, 
+                                                const size_t Lt,
+                                                const size_t nb_eigen_vec,
+                                                const quark& quark,
+                                                const std::string& filename,
+                                                const bool single_file) {
+  const double t = omp_get_wtime();
+
+  MappedFile file(filename);
+  // check if all data are in the file
+  if(file.size() < rows(entity) * cols(entity) * 
+                   (single_file ? sizeof(cmplxf) : sizeof(cmplx))){
+    std::cout << "\n\nFailed to read perambulator\n" << std::endl;
+    exit(0);
+  }
+  file.advise(MADV_SEQUENTIAL);
+
+  reorder(file.data(), 0, rows(entity), nb_eigen_vec, quark, entity, 
+          single_file);
 
   // writing out how long it took to read the file
-  t = clock() - t;
-  std::cout << "\n\t\tin: " << std::fixed << std::setprecision(1)
-            << ((float) t)/CLOCKS_PER_SEC << " seconds" << std::endl;
+  #pragma omp critical (cout)
+  std::cout << "\tReading perambulator from file:\n\t\t" << filename 
+            << "\n\t\tin: " << std::fixed << std::setprecision(1)
+            << omp_get_wtime() - t << " seconds" << std::endl;
+}
+
+/******************************************************************************/
+/*!
+ *  @param entity       The entry where this peram will be stored
+ *  @param Lt           Total number of timeslices - for each peram the same
+ *  @param nb_eigen_vec Total number of eigen vecs - for each peram the same
+ *  @param quark        Contains information about dilution scheme and size
+ *  @param filename     Just the file name
+ *  @param io_params    perambulator_buffer_size is the memory budget for the
+ *                      slab buffer in MB, io_backend decides if fread or 
+ *                      LapH::BinaryReader is used, perambulator_file_precision
+ *                      gives the precision of the file
+ *
+ *  The file is read in slabs of complete rows. If the budget allows it, a slab
+ *  contains an integer number of source timeslices (4*nb_eigen_vec rows), 
+ *  otherwise as many rows as fit, but at least one. Each slab is scattered 
+ *  into peram[entity] before the next one is read, thus the peak extra memory
+ *  is one slab instead of one full perambulator.
+ */
+void LapH::Perambulator::read_perambulator_streaming(
+                                                const size_t entity, 
+                                                const size_t Lt,
+                                                const size_t nb_eigen_vec,
+                                                const quark& quark,
+                                                const std::string& filename,
+                                                const IOParameters& io_params) {
+  const double t = omp_get_wtime();
+  FILE *fp = NULL;
+
+  const bool single_file = io_params.perambulator_file_precision == "single";
+  const size_t nb_rows = rows(entity);
+  const size_t row_bytes = cols(entity) * 
+                           (single_file ? sizeof(cmplxf) : sizeof(cmplx));
+  const size_t rows_per_t = 4 * nb_eigen_vec;
+  size_t rows_per_slab = std::max(size_t(1), 
+                         (io_params.perambulator_buffer_size << 20) / row_bytes);
+  if(rows_per_slab >= rows_per_t)
+    rows_per_slab -= rows_per_slab % rows_per_t;
+  rows_per_slab = std::min(rows_per_slab, nb_rows);
+
+  // the slab is placed with the same misalignment as its offset in the file,
+  // thus O_DIRECT reads go directly into it
+  DirectBuffer slab_buffer(rows_per_slab * row_bytes + direct_alignment);
+  std::unique_ptr<BinaryReader> file;
+  if(io_params.io_backend != "stdio")
+    file.reset(new BinaryReader(filename, io_params));
+  else if((fp = fopen(filename.c_str(), "rb")) == NULL){
+    std::cout << "failed to open file to read perambulaots: " 
+              << filename << "\n" << std::endl;
+    exit(0);
+  }
+  for(size_t row_begin = 0; row_begin < nb_rows; row_begin += rows_per_slab){
+    const size_t row_end = std::min(nb_rows, row_begin + rows_per_slab);
+    const size_t slab_size = (row_end - row_begin) * row_bytes;
+    char* slab = &(slab_buffer[0]) + (row_begin * row_bytes) % direct_alignment;
+    if(file){
+      file->queue(slab, slab_size, row_begin * row_bytes);
+      file->wait();
+    }
+    else{
+      size_t check_read = fread(slab, 1, slab_size, fp);
+      // check if all data were read in
+      if(check_read != slab_size){
+        std::cout << "\n\nFailed to read perambulator\n" << std::endl;
+        exit(0);
+      }
+    }
+    reorder(slab, row_begin, row_end, nb_eigen_vec, quark, entity, 
+            single_file);
+  }
+  if(fp != NULL)
+    fclose(fp);
+
+  // writing out how long it took to read the file
+  #pragma omp critical (cout)
+  std::cout << "\tReading perambulator from file:\n\t\t" << filename 
+            << "\n\t\tin: " << std::fixed << std::setprecision(1)
+            << omp_get_wtime() - t << " seconds (slabs of " << rows_per_slab
+            << " rows)" << std::endl;
 }
 
 /******************************************************************************/
@@ -70,26 +301,89 @@ void LapH::Perambulator::read_perambulator(const size_t entity,
  *  @param nb_eigen_vec  Total number of eigen vecs - for each peram the same
  *  @param quark         Contains information about dilution scheme and size
  *  @param filename_list Vector which contains all file names
+ *  @param io_params     Decides which routine is used to read a single file 
+ *                       and how many files are read concurrently
  *
  *  Loops over \code nb_entities = quark.size() * nb_rnd_vec \endcode. For each 
- *  internally read_perambulator() for a single file is called
+ *  internally read_perambulator(), read_perambulator_mmap() or 
+ *  read_perambulator_streaming() for a single file is called. The files are
+ *  distributed over io_params.nb_io_threads threads, each one writes into its
+ *  preallocated matrix. These are plain threads, not an OpenMP team: nested
+ *  OpenMP regions are disabled, thus the reordering inside would run on a 
+ *  single thread. Instead each reader reorders with an equal share of the 
+ *  OpenMP threads of the caller. The aggregate bandwidth is printed at the 
+ *  end.
  */
 void LapH::Perambulator::read_perambulators_from_separate_files(
                                  const size_t Lt, const size_t nb_eigen_vec,
                                  const std::vector<quark>& quark,
-                                 const std::vector<std::string>&filename_list) {
+                                 const std::vector<std::string>&filename_list,
+                                 const IOParameters& io_params) {
 
-  if(filename_list.size() != peram.size())
+  const size_t nb_entities = peram.size() + peram_sp.size();
+  if(filename_list.size() != nb_entities)
     std::cout << "Problem when reading perambulators: The number of "
               << "perambulators read is not the same as the expected one!" 
               << std::endl;
-  size_t j = 0; // TODO: Not beautiful but practical - Think about change
-  for(size_t i = 0; i < quark.size(); i++){
-    for(size_t r = 0; r < quark[i].number_of_rnd_vec; r++){
-      read_perambulator(j, Lt, nb_eigen_vec, quark[i], filename_list[j]);
-      j++;
-    }
+  if(io_params.handling_perambulators != "read" && 
+     io_params.handling_perambulators != "mmap" &&
+     io_params.handling_perambulators != "stream"){
+    std::cout << "\n\tThe flag handling_perambulators in input file is "
+              << "wrong!!\n\n" << std::endl;
+    exit(0);
   }
+  if(io_params.perambulator_file_precision != "double" && 
+     io_params.perambulator_file_precision != "single"){
+    std::cout << "\n\tThe flag perambulator_file_precision in input file is "
+              << "wrong!!\n\n" << std::endl;
+    exit(0);
+  }
+  const bool single_file = io_params.perambulator_file_precision == "single";
+  // flattening the loop over quarks and random vectors
+  std::vector<size_t> quark_of_entity;
+  for(size_t i = 0; i < quark.size(); i++)
+    for(size_t r = 0; r < quark[i].number_of_rnd_vec; r++)
+      quark_of_entity.push_back(i);
+
+  const double t = omp_get_wtime();
+  const size_t nb_readers = std::max(size_t(1), std::min(
+                          io_params.nb_io_threads, quark_of_entity.size()));
+  const int nb_reorder_threads = std::max(1, omp_get_max_threads() / 
+                                             int(nb_readers));
+  std::atomic<size_t> next_entity(0);
+  auto reader = [&]() {
+    // the number of OpenMP threads is a per-thread setting
+    omp_set_num_threads(nb_reorder_threads);
+    for(size_t j = next_entity++; j < quark_of_entity.size(); 
+               j = next_entity++){
+      const size_t i = quark_of_entity[j];
+      if(io_params.handling_perambulators == "mmap")
+        read_perambulator_mmap(j, Lt, nb_eigen_vec, quark[i], 
+                               filename_list[j], single_file);
+      else if(io_params.handling_perambulators == "stream")
+        read_perambulator_streaming(j, Lt, nb_eigen_vec, quark[i], 
+                                    filename_list[j], io_params);
+      else
+        read_perambulator(j, Lt, nb_eigen_vec, quark[i], filename_list[j],
+                          io_params);
+    }
+  };
+  std::vector<std::thread> readers;
+  for(size_t r = 0; r < nb_readers; r++)
+    readers.emplace_back(reader);
+  for(auto& r : readers)
+    r.join();
+  const double time = omp_get_wtime() - t;
+
+  size_t bytes = 0;
+  for(size_t j = 0; j < quark_of_entity.size(); j++)
+    bytes += rows(j) * cols(j) * 
+             (single_file ? sizeof(cmplxf) : sizeof(cmplx));
+  std::cout << "\tRead " << quark_of_entity.size() << " perambulators ("
+            << std::fixed << std::setprecision(1) << bytes / 1048576. 
+            << " MB) with " << nb_readers << " io threads in " 
+            << time << " seconds: " << bytes / 1048576. / time << " MB/s" 
+            << std::endl;
 }
 
 /******************************************************************************/
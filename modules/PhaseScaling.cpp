@@ -0,0 +1,156 @@
+#include "PhaseScaling.h"
+
+// target attributes for single functions are supported since gcc 4.9
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 || \
+                            (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define PHASE_SCALING_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*Kernel)(const double*, const size_t, const double*,
+                       const size_t, const size_t, double*, const size_t);
+
+/******************************************************************************/
+/*! Scales the sites [begin, nb_sites) of all columns, v, phase and w point to
+ *  the interleaved real and imaginary parts, the leading dimensions are given
+ *  in doubles
+ */
+inline void scale_sites_tail(const double* v, const size_t ld_v,
+                             const double* phase, const size_t begin,
+                             const size_t nb_sites, const size_t nb_cols,
+                             double* w, const size_t ld_w){
+  for(size_t s = begin; s < nb_sites; s++){
+    const double re = phase[2*s], im = phase[2*s+1];
+    for(size_t col = 0; col < nb_cols; col++){
+      const double* v_s = v + col*ld_v + 6*s;
+      double* w_s = w + col*ld_w + 6*s;
+      for(size_t r = 0; r < 6; r += 2){
+        const double v_re = v_s[r], v_im = v_s[r+1];
+        w_s[r]   = re * v_re - im * v_im;
+        w_s[r+1] = re * v_im + im * v_re;
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+void scale_sites_generic(const double* v, const size_t ld_v,
+                         const double* phase, const size_t nb_sites,
+                         const size_t nb_cols, double* w, const size_t ld_w){
+  scale_sites_tail(v, ld_v, phase, 0, nb_sites, nb_cols, w, ld_w);
+}
+
+#ifdef PHASE_SCALING_X86
+/******************************************************************************/
+/*! Two complex numbers per register, two sites are three registers */
+__attribute__((target("avx2,fma")))
+void scale_sites_avx2(const double* v, const size_t ld_v, const double* phase,
+                      const size_t nb_sites, const size_t nb_cols, double* w,
+                      const size_t ld_w){
+  size_t s = 0;
+  for(; s + 2 <= nb_sites; s += 2){
+    // (re0, im0, re1, im1) -> (re0, re0, re1, re1) and (im0, im0, im1, im1)
+    const __m256d p = _mm256_loadu_pd(phase + 2*s);
+    const __m256d re = _mm256_permute_pd(p, 0x0);
+    const __m256d im = _mm256_permute_pd(p, 0xf);
+    // the registers hold the rows of the sites (0, 0), (0, 1) and (1, 1)
+    const __m256d re0 = _mm256_permute2f128_pd(re, re, 0x00);
+    const __m256d re2 = _mm256_permute2f128_pd(re, re, 0x11);
+    const __m256d im0 = _mm256_permute2f128_pd(im, im, 0x00);
+    const __m256d im2 = _mm256_permute2f128_pd(im, im, 0x11);
+    for(size_t col = 0; col < nb_cols; col++){
+      const double* v_s = v + col*ld_v + 6*s;
+      double* w_s = w + col*ld_w + 6*s;
+      const __m256d x0 = _mm256_loadu_pd(v_s);
+      const __m256d x1 = _mm256_loadu_pd(v_s + 4);
+      const __m256d x2 = _mm256_loadu_pd(v_s + 8);
+      // (re, im) -> (im, re)
+      const __m256d t0 = _mm256_mul_pd(_mm256_permute_pd(x0, 0x5), im0);
+      const __m256d t1 = _mm256_mul_pd(_mm256_permute_pd(x1, 0x5), im);
+      const __m256d t2 = _mm256_mul_pd(_mm256_permute_pd(x2, 0x5), im2);
+      _mm256_storeu_pd(w_s,     _mm256_fmaddsub_pd(x0, re0, t0));
+      _mm256_storeu_pd(w_s + 4, _mm256_fmaddsub_pd(x1, re, t1));
+      _mm256_storeu_pd(w_s + 8, _mm256_fmaddsub_pd(x2, re2, t2));
+    }
+  }
+  scale_sites_tail(v, ld_v, phase, s, nb_sites, nb_cols, w, ld_w);
+}
+
+/******************************************************************************/
+/*! Four complex numbers per register, four sites are three registers */
+__attribute__((target("avx512f")))
+void scale_sites_avx512(const double* v, const size_t ld_v,
+                        const double* phase, const size_t nb_sites,
+                        const size_t nb_cols, double* w, const size_t ld_w){
+  // positions of the real parts of the sites (0, 0, 0, 1), (1, 1, 2, 2) and
+  // (2, 3, 3, 3) in (re0, im0, ..., re3, im3), the imaginary parts follow
+  const __m512i idx0 = _mm512_setr_epi64(0, 0, 0, 0, 0, 0, 2, 2);
+  const __m512i idx1 = _mm512_setr_epi64(2, 2, 2, 2, 4, 4, 4, 4);
+  const __m512i idx2 = _mm512_setr_epi64(4, 4, 6, 6, 6, 6, 6, 6);
+  const __m512i one = _mm512_set1_epi64(1);
+  size_t s = 0;
+  for(; s + 4 <= nb_sites; s += 4){
+    const __m512d p = _mm512_loadu_pd(phase + 2*s);
+    const __m512d re0 = _mm512_permutexvar_pd(idx0, p);
+    const __m512d re1 = _mm512_permutexvar_pd(idx1, p);
+    const __m512d re2 = _mm512_permutexvar_pd(idx2, p);
+    const __m512d im0 = _mm512_permutexvar_pd(_mm512_add_epi64(idx0, one), p);
+    const __m512d im1 = _mm512_permutexvar_pd(_mm512_add_epi64(idx1, one), p);
+    const __m512d im2 = _mm512_permutexvar_pd(_mm512_add_epi64(idx2, one), p);
+    for(size_t col = 0; col < nb_cols; col++){
+      const double* v_s = v + col*ld_v + 6*s;
+      double* w_s = w + col*ld_w + 6*s;
+      const __m512d x0 = _mm512_loadu_pd(v_s);
+      const __m512d x1 = _mm512_loadu_pd(v_s + 8);
+      const __m512d x2 = _mm512_loadu_pd(v_s + 16);
+      // (re, im) -> (im, re)
+      const __m512d t0 = _mm512_mul_pd(_mm512_permute_pd(x0, 0x55), im0);
+      const __m512d t1 = _mm512_mul_pd(_mm512_permute_pd(x1, 0x55), im1);
+      const __m512d t2 = _mm512_mul_pd(_mm512_permute_pd(x2, 0x55), im2);
+      _mm512_storeu_pd(w_s,      _mm512_fmaddsub_pd(x0, re0, t0));
+      _mm512_storeu_pd(w_s + 8,  _mm512_fmaddsub_pd(x1, re1, t1));
+      _mm512_storeu_pd(w_s + 16, _mm512_fmaddsub_pd(x2, re2, t2));
+    }
+  }
+  scale_sites_tail(v, ld_v, phase, s, nb_sites, nb_cols, w, ld_w);
+}
+#endif
+
+/******************************************************************************/
+struct Dispatch {
+  Kernel kernel;
+  const char* isa;
+};
+
+/*! Picks the kernel once, the initialisation of the static is thread safe */
+const Dispatch& dispatch(){
+  static const Dispatch d = []() -> Dispatch {
+#ifdef PHASE_SCALING_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+      return Dispatch{scale_sites_avx512, "avx512"};
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return Dispatch{scale_sites_avx2, "avx2"};
+#endif
+    return Dispatch{scale_sites_generic, "generic"};
+  }();
+  return d;
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+void LapH::scale_by_phase(const cmplx* V, const size_t ld_V,
+                          const cmplx* phase, const size_t nb_sites,
+                          const size_t nb_cols, cmplx* W, const size_t ld_W){
+  dispatch().kernel(reinterpret_cast<const double*>(V), 2*ld_V,
+                    reinterpret_cast<const double*>(phase), nb_sites, nb_cols,
+                    reinterpret_cast<double*>(W), 2*ld_W);
+}
+
+/******************************************************************************/
+const char* LapH::phase_scaling_isa(){
+  return dispatch().isa;
+}
@@ -0,0 +1,174 @@
+#include "Quarklines.h"
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+/*!
+ *  @param dilE Number of eigenvector dilution blocks
+ *  @param nev  Number of eigenvectors
+ */
+LapH::QuarklineCore::QuarklineCore(const size_t dilE, const size_t nev) :
+                                         dilE(dilE), nev(nev), needed(),
+                                         panel(), core(), buffer() {
+  clear();
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::clear(){
+  for(auto& row : needed)
+    row.fill(false);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::request(const size_t gamma_id){
+  for(size_t r = 0; r < 4; r++)
+    needed[r][gamma_row[gamma_id][r]] = true;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::set_perambulator(const Perambulator& peram,
+                const size_t t, const size_t block_peram,
+                const std::vector<std::pair<size_t, size_t> >& rnd_vec_ids,
+                const size_t first, const size_t last){
+
+  for(size_t s = 0; s < 4; s++){
+    bool used = false;
+    for(size_t r = 0; r < 4; r++)
+      used = used || needed[r][s];
+    if(!used)
+      continue;
+    panel[s].resize(nev, (last - first)*4*dilE);
+    for(size_t rnd = first; rnd < last; rnd++)
+      panel[s].middleCols((rnd - first)*4*dilE, 4*dilE) =
+        peram.block(rnd_vec_ids[rnd].second, (t*4 + s)*nev,
+                    block_peram*4*dilE, nev, 4*dilE, buffer);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::multiply(const size_t r,
+                          const Eigen::Ref<const Eigen::MatrixXcd>& L_r){
+  for(size_t s = 0; s < 4; s++)
+    if(needed[r][s])
+      core[r][s].noalias() = L_r * panel[s];
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+template <int G> 
+void LapH::QuarklineCore::gamma_Q1(const size_t rnd, 
+                                   Eigen::MatrixXcd& Q1) const {
+  Q1.middleRows(0, dilE) = view(0, gamma_row[G][0], rnd).
+                             unaryExpr(Phase<gamma_phase[G][0]>());
+  Q1.middleRows(dilE, dilE) = view(1, gamma_row[G][1], rnd).
+                                unaryExpr(Phase<gamma_phase[G][1]>());
+  Q1.middleRows(2*dilE, dilE) = view(2, gamma_row[G][2], rnd).
+                                  unaryExpr(Phase<gamma_phase[G][2]>());
+  Q1.middleRows(3*dilE, dilE) = view(3, gamma_row[G][3], rnd).
+                                  unaryExpr(Phase<gamma_phase[G][3]>());
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+template <int G> 
+void LapH::QuarklineCore::gamma_Q2(const size_t rnd, 
+                                   Eigen::MatrixXcd& Q2) const {
+  Q2 = view(0, gamma_row[G][0], rnd).unaryExpr(Phase<gamma_phase[G][0]>()) +
+       view(1, gamma_row[G][1], rnd).unaryExpr(Phase<gamma_phase[G][1]>()) +
+       view(2, gamma_row[G][2], rnd).unaryExpr(Phase<gamma_phase[G][2]>()) +
+       view(3, gamma_row[G][3], rnd).unaryExpr(Phase<gamma_phase[G][3]>());
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::view_Q1(const size_t gamma_id, const size_t rnd,
+                                  Eigen::MatrixXcd& Q1) const {
+  typedef void (QuarklineCore::*Kernel)(const size_t, 
+                                        Eigen::MatrixXcd&) const;
+  static const Kernel kernel[16] = {
+    &QuarklineCore::gamma_Q1<0>,  &QuarklineCore::gamma_Q1<1>,
+    &QuarklineCore::gamma_Q1<2>,  &QuarklineCore::gamma_Q1<3>,
+    &QuarklineCore::gamma_Q1<4>,  &QuarklineCore::gamma_Q1<5>,
+    &QuarklineCore::gamma_Q1<6>,  &QuarklineCore::gamma_Q1<7>,
+    &QuarklineCore::gamma_Q1<8>,  &QuarklineCore::gamma_Q1<9>,
+    &QuarklineCore::gamma_Q1<10>, &QuarklineCore::gamma_Q1<11>,
+    &QuarklineCore::gamma_Q1<12>, &QuarklineCore::gamma_Q1<13>,
+    &QuarklineCore::gamma_Q1<14>, &QuarklineCore::gamma_Q1<15>};
+  (this->*kernel[gamma_id])(rnd, Q1);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::QuarklineCore::view_Q2(const size_t gamma_id, const size_t rnd,
+                                  Eigen::MatrixXcd& Q2) const {
+  typedef void (QuarklineCore::*Kernel)(const size_t, 
+                                        Eigen::MatrixXcd&) const;
+  static const Kernel kernel[16] = {
+    &QuarklineCore::gamma_Q2<0>,  &QuarklineCore::gamma_Q2<1>,
+    &QuarklineCore::gamma_Q2<2>,  &QuarklineCore::gamma_Q2<3>,
+    &QuarklineCore::gamma_Q2<4>,  &QuarklineCore::gamma_Q2<5>,
+    &QuarklineCore::gamma_Q2<6>,  &QuarklineCore::gamma_Q2<7>,
+    &QuarklineCore::gamma_Q2<8>,  &QuarklineCore::gamma_Q2<9>,
+    &QuarklineCore::gamma_Q2<10>, &QuarklineCore::gamma_Q2<11>,
+    &QuarklineCore::gamma_Q2<12>, &QuarklineCore::gamma_Q2<13>,
+    &QuarklineCore::gamma_Q2<14>, &QuarklineCore::gamma_Q2<15>};
+  (this->*kernel[gamma_id])(rnd, Q2);
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+/*!
+ *  Row block r of Q1 is the phase times @f$ rV^\dagger V_r P_{row[r]} @f$,
+ *  i.e. a view on the block (r, row[r]) of the core. The random vector pairs
+ *  with the same first random vector share rVdaggerV and are multiplied at
+ *  once.
+ */
+void LapH::QuarklineCore::build_Q1(const Perambulator& peram,
+                const OperatorsForMesons& meson_operator,
+                const size_t t, const size_t block_peram,
+                const std::vector<QuarklineQ1Indices>& ql_lookup,
+                const std::vector<RandomIndexCombinationsQ2>& ric_lookup,
+                array_quarkline& Q1, const size_t i1, const size_t i2){
+
+  std::vector<bool> done(ql_lookup.size(), false);
+  for(size_t op = 0; op < ql_lookup.size(); op++){
+    if(done[op])
+      continue;
+    const auto& qll = ql_lookup[op];
+    // all entries which only differ in gamma
+    std::vector<size_t> group;
+    clear();
+    for(size_t op2 = op; op2 < ql_lookup.size(); op2++){
+      if(!done[op2] && ql_lookup[op2].id_rvdaggerv == qll.id_rvdaggerv &&
+         ql_lookup[op2].id_ric_lookup == qll.id_ric_lookup){
+        group.emplace_back(op2);
+        done[op2] = true;
+        request(ql_lookup[op2].gamma[0]);
+      }
+    }
+
+    const auto& ric = ric_lookup[qll.id_ric_lookup];
+    size_t first = 0;
+    while(first < ric.rnd_vec_ids.size()){
+      size_t last = first + 1;
+      while(last < ric.rnd_vec_ids.size() &&
+            ric.rnd_vec_ids[last].first == ric.rnd_vec_ids[first].first)
+        last++;
+      const size_t rid1 = ric.rnd_vec_ids[first].first - ric.offset.first;
+      const Eigen::MatrixXcd& rvdaggerv =
+                   meson_operator.return_rvdaggerv(qll.id_rvdaggerv, t, rid1);
+      set_perambulator(peram, t, block_peram, ric.rnd_vec_ids, first, last);
+      for(size_t r = 0; r < 4; r++)
+        multiply(r, rvdaggerv.middleRows(r*dilE, dilE));
+
+      for(const auto& id : group)
+        for(size_t rnd = first; rnd < last; rnd++)
+          view_Q1(ql_lookup[id].gamma[0], rnd - first, 
+                  Q1[i1][i2][ql_lookup[id].id][rnd]);
+      first = last;
+    }
+  }
+}
@@ -1,210 +1,13 @@
 #include "Quarklines.h"
 
-namespace { // some internal namespace
-
-static const std::complex<double> I(0.0, 1.0);
-// Look-up table for gamma matrices. For every Gamma structure (currently 0-15)
-// the four non-zero values are specified.
-static void create_gamma (std::vector<LapH::gamma_lookup>& gamma, const int i) {
-  try {
-    switch(i) {
-    case 0: // gamma_0
-      gamma[0].row[0] = 2;
-      gamma[0].value[0] = 1;
-      gamma[0].row[1] = 3;
-      gamma[0].value[1] = 1;
-      gamma[0].row[2] = 0;
-      gamma[0].value[2] = 1;
-      gamma[0].row[3] = 1;
-      gamma[0].value[3] = 1;
-      break;
-
-    case 1: // gamma_1
-      gamma[1].row[0] = 3;
-      gamma[1].value[0] = -I; 
-      gamma[1].row[1] = 2;
-      gamma[1].value[1] = -I; 
-      gamma[1].row[2] = 1;
-      gamma[1].value[2] = I;
-      gamma[1].row[3] = 0;
-      gamma[1].value[3] = I;
-      break;
-
-    case 2: // gamma_2
-      gamma[2].row[0] = 3;
-      gamma[2].value[0] = -1; 
-      gamma[2].row[1] = 2;
-      gamma[2].value[1] = 1;
-      gamma[2].row[2] = 1;
-      gamma[2].value[2] = 1;
-      gamma[2].row[3] = 0;
-      gamma[2].value[3] = -1; 
-      break;
-
-    case 3: // gamma_3
-      gamma[3].row[0] = 2;
-      gamma[3].value[0] = -I; 
-      gamma[3].row[1] = 3;
-      gamma[3].value[1] = I;
-      gamma[3].row[2] = 0;
-      gamma[3].value[2] = I;
-      gamma[3].row[3] = 1;
-      gamma[3].value[3] = -I; 
-      break;
-
-    case 4: // unity
-      gamma[4].row[0] = 0;
-      gamma[4].value[0] = 1;
-      gamma[4].row[1] = 1;
-      gamma[4].value[1] = 1;
-      gamma[4].row[2] = 2;
-      gamma[4].value[2] = 1;
-      gamma[4].row[3] = 3;
-      gamma[4].value[3] = 1;
-      break;
-
-    case 5: // gamma_5
-      gamma[5].row[0] = 0;
-      gamma[5].value[0] = 1;
-      gamma[5].row[1] = 1;
-      gamma[5].value[1] = 1;
-      gamma[5].row[2] = 2;
-      gamma[5].value[2] = -1;
-      gamma[5].row[3] = 3;
-      gamma[5].value[3] = -1;
-      break;
-
-    case 6: // gamma_0 * gamma_5
-      gamma[6].row[0] = 2;
-      gamma[6].value[0] = -1;
-      gamma[6].row[1] = 3;
-      gamma[6].value[1] = -1;
-      gamma[6].row[2] = 0;
-      gamma[6].value[2] = 1;
-      gamma[6].row[3] = 1;
-      gamma[6].value[3] = 1;
-      break;
-
-    case 7: // gamma_1 * gamma_5
-      gamma[7].row[0] = 3;
-      gamma[7].value[0] = I;
-      gamma[7].row[1] = 2;
-      gamma[7].value[1] = I;
-      gamma[7].row[2] = 1;
-      gamma[7].value[2] = I;
-      gamma[7].row[3] = 0;
-      gamma[7].value[3] = I;
-      break;
-
-    case 8: // gamma_2 * gamma_5
-      gamma[8].row[0] = 3;
-      gamma[8].value[0] = 1;
-      gamma[8].row[1] = 2;
-      gamma[8].value[1] = -1;
-      gamma[8].row[2] = 1;
-      gamma[8].value[2] = 1;
-      gamma[8].row[3] = 0;
-      gamma[8].value[3] = -1;
-      break;
-
-    case 9: // gamma_3 * gamma_5
-      gamma[9].row[0] = 2;
-      gamma[9].value[0] = I;
-      gamma[9].row[1] = 3;
-      gamma[9].value[1] = -I;
-      gamma[9].row[2] = 0;
-      gamma[9].value[2] = I;
-      gamma[9].row[3] = 1;
-      gamma[9].value[3] = -I;
-      break;
-
-    case 10: // gamma_0 * gamma_1
-      gamma[10].row[0] = 1;
-      gamma[10].value[0] = I;
-      gamma[10].row[1] = 0;
-      gamma[10].value[1] = I;
-      gamma[10].row[2] = 3;
-      gamma[10].value[2] = -I;
-      gamma[10].row[3] = 2;
-      gamma[10].value[3] = -I;
-      break;
-
-    case 11: // gamma_0 * gamma_2
-      gamma[11].row[0] = 1;
-      gamma[11].value[0] = 1;
-      gamma[11].row[1] = 0;
-      gamma[11].value[1] = -1;
-      gamma[11].row[2] = 3;
-      gamma[11].value[2] = -1;
-      gamma[11].row[3] = 2;
-      gamma[11].value[3] = 1;
-      break;
-
-    case 12: // gamma_0 * gamma_3
-      gamma[12].row[0] = 0;
-      gamma[12].value[0] = I;
-      gamma[12].row[1] = 1;
-      gamma[12].value[1] = -I;
-      gamma[12].row[2] = 2;
-      gamma[12].value[2] = -I;
-      gamma[12].row[3] = 3;
-      gamma[12].value[3] = I;
-      break;
-
-    case 13: // gamma_0 * gamma_1 * gamma_5
-      gamma[13].row[0] = 1;
-      gamma[13].value[0] = I;
-      gamma[13].row[1] = 0;
-      gamma[13].value[1] = I;
-      gamma[13].row[2] = 3;
-      gamma[13].value[2] = I;
-      gamma[13].row[3] = 2;
-      gamma[13].value[3] = I;
-      break;
-
-    case 14: // gamma_0 * gamma_2 * gamma_5
-      gamma[14].row[0] = 1;
-      gamma[14].value[0] = 1;
-      gamma[14].row[1] = 0;
-      gamma[14].value[1] = -1;
-      gamma[14].row[2] = 3;
-      gamma[14].value[2] = 1;
-      gamma[14].row[3] = 2;
-      gamma[14].value[3] = -1;
-      break;
-
-    case 15: // gamma_0 * gamma_3 * gamma_5
-      gamma[15].row[0] = 0;
-      gamma[15].value[0] = I;
-      gamma[15].row[1] = 1;
-      gamma[15].value[1] = -I;
-      gamma[15].row[2] = 2;
-      gamma[15].value[2] = I;
-      gamma[15].row[3] = 3;
-      gamma[15].value[3] = -I;
-      break;
-
-    default:
-      printf("Dirac component %d not found in BasicOperator::create_gamma\n",i);
-      exit(0);
-    }
-  return;
-  }
-  catch(std::exception& e){
-    std::cout << e.what() << "in: BasicOperator::create_gamma\n";
-    exit(0);
-  }
-}
-// -----------------------------------------------------------------------------
-// -----------------------------------------------------------------------------
-} // internal namespace ends here
-
 LapH::Quarklines_one_t::Quarklines_one_t(
                      const size_t Lt, const size_t dilT, 
                      const size_t dilE, const size_t nev, 
                      const QuarklineLookup& quarkline_lookuptable,
                      const std::vector<RandomIndexCombinationsQ2>& ric_lookup) :
-                                    Lt(Lt), dilT(dilT), dilE(dilE), nev(nev) {
+                                    Lt(Lt), dilT(dilT), dilE(dilE), nev(nev),
+                                    core(dilE, nev), M_cache(), 
+                                    M_cache_hits(0), M_cache_misses(0) {
 
   // needed to construct quarklines on individual time slices
   int tt2 = 0;
@@ -247,7 +50,7 @@ LapH::Quarklines_one_t::Quarklines_one_t(
   // creating gamma matrices
   gamma.resize(16);
   for(int i = 0; i < 16; ++i)
-    create_gamma(gamma, i);
+    gamma[i] = create_gamma(i);
 }
 
 // -----------------------------------------------------------------------------
@@ -258,45 +61,10 @@ void LapH::Quarklines_one_t::build_Q1_one_t(const Perambulator& peram,
               const std::vector<QuarklineQ1Indices>& ql_lookup,
               const std::vector<RandomIndexCombinationsQ2>& ric_lookup){
 
-//#pragma omp parallel for schedule(dynamic)
-  for(const auto& qll : ql_lookup){
-    const size_t offset = ric_lookup[qll.id_ric_lookup].offset.first;
-    size_t rnd_counter = 0;
-    for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-      const size_t rid1 = rnd_id.first - offset; 
-      const size_t gamma_id = qll.gamma[0]; // TODO: hard coded! VERY BAD!!!
-      for(size_t row = 0; row < 4; row++){
-      for(size_t col = 0; col < 4; col++){
-
-        Q1[0][0][qll.id][rnd_counter].block(row*dilE, col*dilE, dilE, dilE)=
-          gamma[gamma_id].value[row] *  
-          meson_operator.return_rvdaggerv(qll.id_rvdaggerv, t_source, rid1).
-                                                block(row*dilE, 0, dilE, nev)*
-          peram[rnd_id.second].block((t_source*4+gamma[gamma_id].row[row])*nev, 
-                                     (t_sink/dilT*4 + col)*dilE, nev, dilE);
-      }}
-      rnd_counter++;
-    }
-  }
-//#pragma omp parallel for schedule(dynamic)
-  for(const auto& qll : ql_lookup){
-    const size_t offset = ric_lookup[qll.id_ric_lookup].offset.first;
-    size_t rnd_counter = 0;
-    for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-      const size_t rid1 = rnd_id.first - offset; 
-      const size_t gamma_id = qll.gamma[0]; // TODO: hard coded! VERY BAD!!!
-      for(size_t row = 0; row < 4; row++){
-      for(size_t col = 0; col < 4; col++){
-        Q1[1][0][qll.id][rnd_counter].block(row*dilE, col*dilE, dilE, dilE)=
-          gamma[gamma_id].value[row] *  
-          meson_operator.return_rvdaggerv(qll.id_rvdaggerv, t_sink, rid1).
-                                                block(row*dilE, 0, dilE, nev)*
-          peram[rnd_id.second].block((t_sink*4+gamma[gamma_id].row[row])*nev, 
-                                     (t_source/dilT*4 + col)*dilE, nev, dilE);
-      }}
-      rnd_counter++;
-    }
-  }
+  core.build_Q1(peram, meson_operator, t_source, t_sink/dilT, 
+                ql_lookup, ric_lookup, Q1, 0, 0);
+  core.build_Q1(peram, meson_operator, t_sink, t_source/dilT, 
+                ql_lookup, ric_lookup, Q1, 1, 0);
 }
 
 // -----------------------------------------------------------------------------
@@ -306,50 +74,138 @@ void LapH::Quarklines_one_t::build_Q1_mult_t(const Perambulator& peram,
               const int t1_block, const int t2_block,
               const std::vector<QuarklineQ1Indices>& ql_lookup,
               const std::vector<RandomIndexCombinationsQ2>& ric_lookup){
+
   // t1 -> t2 -----------------------------------------------------------------
   size_t pos = 0;
   for(int t1 = dilT*t1_block; t1 < dilT*(t1_block+1); t1++){
-    for(const auto& qll : ql_lookup){
-      const size_t offset = ric_lookup[qll.id_ric_lookup].offset.first;
-      size_t rnd_counter = 0;
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        const size_t rid1 = rnd_id.first - offset; 
-        const size_t gamma_id = qll.gamma[0]; // TODO: hard coded! VERY BAD!!!
-        for(size_t row = 0; row < 4; row++){
-        for(size_t col = 0; col < 4; col++){
-          Q1[pos][0][qll.id][rnd_counter].block(row*dilE, col*dilE, dilE, dilE)=
-            gamma[gamma_id].value[row] *  
-            meson_operator.return_rvdaggerv(qll.id_rvdaggerv, t1, rid1).
-                                                  block(row*dilE, 0, dilE, nev)*
-            peram[rnd_id.second].block((t1*4+gamma[gamma_id].row[row])*nev, 
-                                       (t2_block*4 + col)*dilE, nev, dilE);
-        }}
-        rnd_counter++;
-      }
-    }
+    core.build_Q1(peram, meson_operator, t1, t2_block, ql_lookup, 
+                  ric_lookup, Q1, pos, 0);
     pos++;
   }
   // t2 -> t1 -----------------------------------------------------------------
   for(int t2 = dilT*t2_block; t2 < dilT*(t2_block+1); t2++){
-    for(const auto& qll : ql_lookup){
-      const size_t offset = ric_lookup[qll.id_ric_lookup].offset.first;
-      size_t rnd_counter = 0;
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        const size_t rid1 = rnd_id.first - offset; 
-        const size_t gamma_id = qll.gamma[0]; // TODO: hard coded! VERY BAD!!!
-        for(size_t row = 0; row < 4; row++){
-        for(size_t col = 0; col < 4; col++){
-          Q1[pos][0][qll.id][rnd_counter].block(row*dilE, col*dilE, dilE, dilE)=
-            gamma[gamma_id].value[row] *  
-            meson_operator.return_rvdaggerv(qll.id_rvdaggerv, t2, rid1).
-                                                  block(row*dilE, 0, dilE, nev)*
-            peram[rnd_id.second].block((t2*4+gamma[gamma_id].row[row])*nev, 
-                                       (t1_block*4 + col)*dilE, nev, dilE);
-        }}
-        rnd_counter++;
+    core.build_Q1(peram, meson_operator, t2, t1_block, ql_lookup, 
+                  ric_lookup, Q1, pos, 0);
+    pos++;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::Quarklines_one_t::build_M(const Perambulator& peram,
+                      const OperatorsForMesons& meson_operator,
+                      const size_t t1, const size_t block_M,
+                      const QuarklineQ2Indices& qll, const size_t rnd,
+                      Eigen::MatrixXcd& M, Eigen::MatrixXcd& buffer) const {
+
+  const bool unity = meson_operator.is_vdaggerv_unity(qll.id_vdaggerv);
+  M.resize(4 * dilE, 4 * nev);
+  for(size_t row = 0; row < 4; row++){
+  for(size_t col = 0; col < 4; col++){
+    if(unity)
+      M.block(col*dilE, row*nev, dilE, nev) =
+        peram.block(rnd, (t1*4 + row)*nev, (block_M*4 + col)*dilE, 
+                                  nev, dilE, buffer).adjoint();
+    else if(!qll.need_vdaggerv_dag)
+      M.block(col*dilE, row*nev, dilE, nev).noalias() =
+        peram.block(rnd, (t1*4 + row)*nev, (block_M*4 + col)*dilE, 
+                                  nev, dilE, buffer).adjoint() *
+        meson_operator.return_vdaggerv(qll.id_vdaggerv, t1);
+    else
+      M.block(col*dilE, row*nev, dilE, nev).noalias() =
+        peram.block(rnd, (t1*4 + row)*nev, (block_M*4 + col)*dilE, 
+                                  nev, dilE, buffer).adjoint() *
+        meson_operator.return_vdaggerv(qll.id_vdaggerv, t1).adjoint();
+    // gamma_5 trick
+    if( ((row + col) == 3) || (abs(row - col) > 1) )
+      M.block(col*dilE, row*nev, dilE, nev) *= -1.;
+  }}
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+const Eigen::MatrixXcd& LapH::Quarklines_one_t::return_M(
+                      const Perambulator& peram,
+                      const OperatorsForMesons& meson_operator,
+                      const size_t t1, const size_t block_M,
+                      const QuarklineQ2Indices& qll, const size_t rnd,
+                      Eigen::MatrixXcd& buffer) {
+
+  const auto key = std::make_tuple(t1, block_M, rnd, qll.id_vdaggerv, 
+                                   qll.need_vdaggerv_dag);
+  auto it = M_cache.find(key);
+  if(it != M_cache.end()){
+    M_cache_hits++;
+    return it->second;
+  }
+  M_cache_misses++;
+  it = M_cache.insert(std::make_pair(key, Eigen::MatrixXcd())).first;
+  build_M(peram, meson_operator, t1, block_M, qll, rnd, it->second, buffer);
+  return it->second;
+}
+
+// -----------------------------------------------------------------------------
+// -----------------------------------------------------------------------------
+void LapH::Quarklines_one_t::build_Q2_one_t(const Perambulator& peram,
+                      const OperatorsForMesons& meson_operator,
+                      const size_t t1, const size_t block_M,
+                      const size_t block_peram, const size_t pos,
+                      const std::vector<QuarklineQ2Indices>& ql_lookup,
+                      const std::vector<RandomIndexCombinationsQ2>& ric_lookup,
+                      array_quarkline& Q2, const bool keep_M){
+
+  // holds the perambulator blocks for single precision storage
+  Eigen::MatrixXcd buffer;
+
+  std::vector<bool> done(ql_lookup.size(), false);
+  for(size_t op = 0; op < ql_lookup.size(); op++){
+    if(done[op])
+      continue;
+    const auto& qll = ql_lookup[op];
+    // all entries which only differ in gamma share M and the core
+    std::vector<size_t> group;
+    core.clear();
+    for(size_t op2 = op; op2 < ql_lookup.size(); op2++){
+      if(!done[op2] && ql_lookup[op2].id_vdaggerv == qll.id_vdaggerv &&
+         ql_lookup[op2].need_vdaggerv_dag == qll.need_vdaggerv_dag &&
+         ql_lookup[op2].id_ric_lookup == qll.id_ric_lookup){
+        group.emplace_back(op2);
+        done[op2] = true;
+        core.request(ql_lookup[op2].gamma[0]);
       }
     }
-    pos++;
+
+    const auto& rnd_vec_ids = ric_lookup[qll.id_ric_lookup].rnd_vec_ids;
+    size_t first = 0;
+    while(first < rnd_vec_ids.size()){
+      // M only depends on the first random vector, all following entries
+      // with the same first random vector are multiplied at once
+      size_t last = first + 1;
+      while(last < rnd_vec_ids.size() && 
+            rnd_vec_ids[last].first == rnd_vec_ids[first].first)
+        last++;
+      const Eigen::MatrixXcd& M = return_M(peram, meson_operator, t1, block_M,
+                                        qll, rnd_vec_ids[first].first, buffer);
+      core.set_perambulator(peram, t1, block_peram, rnd_vec_ids, first, last);
+      for(size_t r = 0; r < 4; r++)
+        core.multiply(r, M.middleCols(r*nev, nev));
+
+      // Q2 = sum_r value[r] * M_r * P_row[r]
+      for(const auto& id : group)
+        for(size_t rnd = first; rnd < last; rnd++)
+          core.view_Q2(ql_lookup[id].gamma[0], rnd - first, 
+                       Q2[pos][0][ql_lookup[id].id][rnd]);
+      first = last;
+    }
+  }
+
+  if(keep_M)
+    return;
+  for(auto it = M_cache.begin(); it != M_cache.end();){
+    if(std::get<0>(it->first) == t1 && std::get<1>(it->first) == block_M)
+      it = M_cache.erase(it);
+    else
+      ++it;
   }
 }
 
@@ -364,105 +220,14 @@ void LapH::Quarklines_one_t::build_Q2V_one_t(const Perambulator& peram,
   size_t pos = 0;
   // t1 -> t2 -----------------------------------------------------------------
   for(int t1 = dilT*t1_block; t1 < dilT*(t1_block+1); t1++){
-    int t2 = t2_block;
-    for(const auto& qll : ql_lookup){
-      size_t rnd_counter = 0;
-      int check = -1;
-      Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(4 * dilE, 4 * nev);
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        if(check != rnd_id.first){ // this avoids recomputation
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            if(!qll.need_vdaggerv_dag)
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, (t2*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1);
-            else
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, (t2*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1).adjoint();
-            // gamma_5 trick
-            if( ((row + col) == 3) || (abs(row - col) > 1) )
-              M.block(col*dilE, row*nev, dilE, nev) *= -1.;
-          }}
-        }
-        Q2V[pos][0][qll.id][rnd_counter].setZero(4*dilE, 4*dilE);
-
-        const size_t gamma_id = qll.gamma[0]; 
-
-        for(size_t block_dil = 0; block_dil < 4; block_dil++) {
-          const cmplx value = gamma[gamma_id].value[block_dil];
-          const size_t gamma_index = gamma[gamma_id].row[block_dil];
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-
-          Q2V[pos][0][qll.id][rnd_counter].
-                        block(row*dilE, col*dilE, dilE, dilE) +=
-               value * 
-               M.block(row*dilE, block_dil*nev, dilE, nev) *
-               peram[rnd_id.second].block(
-                          (t1*4 + gamma_index)*nev, 
-                          (t2*4 + col)*dilE, nev, dilE);
-          }}
-        }
-        check = rnd_id.first;
-        rnd_counter++;
-      }
-    }
+    build_Q2_one_t(peram, meson_operator, t1, t2_block, t2_block, pos,
+                   ql_lookup, ric_lookup, Q2V, false);
     pos++;
   }
   // t2 -> t1 -----------------------------------------------------------------
   for(int t1 = dilT*t2_block; t1 < dilT*(t2_block+1); t1++){
-    int t2 = t1_block;
-    for(const auto& qll : ql_lookup){
-      size_t rnd_counter = 0;
-      int check = -1;
-      Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(4 * dilE, 4 * nev);
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        if(check != rnd_id.first){ // this avoids recomputation
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            if(!qll.need_vdaggerv_dag)
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, (t2*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1);
-            else
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, (t2*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1).adjoint();
-            // gamma_5 trick
-            if( ((row + col) == 3) || (abs(row - col) > 1) )
-              M.block(col*dilE, row*nev, dilE, nev) *= -1.;
-          }}
-        }
-        Q2V[pos][0][qll.id][rnd_counter].setZero(4*dilE, 4*dilE);
-
-        const size_t gamma_id = qll.gamma[0]; 
-
-        for(size_t block_dil = 0; block_dil < 4; block_dil++) {
-          const cmplx value = gamma[gamma_id].value[block_dil];
-          const size_t gamma_index = gamma[gamma_id].row[block_dil];
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-
-          Q2V[pos][0][qll.id][rnd_counter].
-                        block(row*dilE, col*dilE, dilE, dilE) +=
-               value * 
-               M.block(row*dilE, block_dil*nev, dilE, nev) *
-               peram[rnd_id.second].block(
-                          (t1*4 + gamma_index)*nev, 
-                          (t2*4 + col)*dilE, nev, dilE);
-
-          }}
-        }
-        check = rnd_id.first;
-        rnd_counter++;
-      }
-    }
+    build_Q2_one_t(peram, meson_operator, t1, t1_block, t1_block, pos,
+                   ql_lookup, ric_lookup, Q2V, false);
     pos++;
   }
 }
@@ -475,108 +240,28 @@ void LapH::Quarklines_one_t::build_Q2L_one_t(const Perambulator& peram,
                       const std::vector<QuarklineQ2Indices>& ql_lookup,
                       const std::vector<RandomIndexCombinationsQ2>& ric_lookup){
 
+  // M is built with the time block of t1 itself and multiplied with the
+  // perambulator columns of the other time block. Thus the M of t1_block 
+  // are kept for all t2_block and only freed when t1_block changes.
+  for(auto it = M_cache.begin(); it != M_cache.end();){
+    if(std::get<0>(it->first) / dilT != size_t(t1_block))
+      it = M_cache.erase(it);
+    else
+      ++it;
+  }
   // t1 -> t2 -----------------------------------------------------------------
   size_t pos = 0;
   for(int t1 = dilT*t1_block; t1 < dilT*(t1_block+1); t1++){
-    Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(4 * dilE, 4 * nev);
-    for(const auto& qll : ql_lookup){
-      size_t rnd_counter = 0;
-      int check = -1;
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        if(check != rnd_id.first){ // this avoids recomputation
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            if(!qll.need_vdaggerv_dag)
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, 
-                                          ((t1/dilT)*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1);
-            else
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, 
-                                          ((t1/dilT)*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1).adjoint();
-            // gamma_5 trick
-            if( ((row + col) == 3) || (abs(row - col) > 1) )
-              M.block(col*dilE, row*nev, dilE, nev) *= -1.;
-          }}
-        }
-        int t2 = dilT*t2_block;
-        (Q2L[pos][0][qll.id][rnd_counter]).setZero(4*dilE, 4*dilE);
-        const size_t gamma_id = qll.gamma[0]; 
-        for(size_t block_dil = 0; block_dil < 4; block_dil++) {
-          const cmplx value = gamma[gamma_id].value[block_dil];
-          const size_t gamma_index = gamma[gamma_id].row[block_dil];
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            Q2L[pos][0][qll.id][rnd_counter].
-                        block(row*dilE, col*dilE, dilE, dilE) +=
-               value * 
-               M.block(row*dilE, block_dil*nev, dilE, nev) *
-               peram[rnd_id.second].block(
-                          (t1*4 + gamma_index)*nev, 
-                          ((t2/dilT)*4 + col)*dilE, nev, dilE);
-          }}
-        }
-        check = rnd_id.first;
-        rnd_counter++;
-      }
-    }
+    build_Q2_one_t(peram, meson_operator, t1, t1/dilT, t2_block, pos,
+                   ql_lookup, ric_lookup, Q2L, true);
     pos++;
   }
   if(t1_block != t2_block){
   // t2 -> t1 -----------------------------------------------------------------
   for(int t1 = dilT*t2_block; t1 < dilT*(t2_block+1); t1++){
-    Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(4 * dilE, 4 * nev);
-    for(const auto& qll : ql_lookup){
-      size_t rnd_counter = 0;
-      int check = -1;
-      for(const auto& rnd_id : ric_lookup[qll.id_ric_lookup].rnd_vec_ids){
-        if(check != rnd_id.first){ // this avoids recomputation
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            if(!qll.need_vdaggerv_dag)
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, 
-                                          ((t1/dilT)*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1);
-            else
-              M.block(col*dilE, row*nev, dilE, nev) =
-                peram[rnd_id.first].block((t1*4 + row)*nev, 
-                                          ((t1/dilT)*4 + col)*dilE, 
-                                          nev, dilE).adjoint() *
-                meson_operator.return_vdaggerv(qll.id_vdaggerv, t1).adjoint();
-            // gamma_5 trick
-            if( ((row + col) == 3) || (abs(row - col) > 1) )
-              M.block(col*dilE, row*nev, dilE, nev) *= -1.;
-          }}
-        }
-        int t2 = dilT*t1_block;
-        (Q2L[pos][0][qll.id][rnd_counter]).setZero(4*dilE, 4*dilE);
-        const size_t gamma_id = qll.gamma[0]; 
-        for(size_t block_dil = 0; block_dil < 4; block_dil++) {
-          const cmplx value = gamma[gamma_id].value[block_dil];
-          const size_t gamma_index = gamma[gamma_id].row[block_dil];
-          for(size_t row = 0; row < 4; row++){
-          for(size_t col = 0; col < 4; col++){
-            Q2L[pos][0][qll.id][rnd_counter].
-                        block(row*dilE, col*dilE, dilE, dilE) +=
-               value * 
-               M.block(row*dilE, block_dil*nev, dilE, nev) *
-               peram[rnd_id.second].block(
-                          (t1*4 + gamma_index)*nev, 
-                          ((t2/dilT)*4 + col)*dilE, nev, dilE);
-          }}
-        }
-        check = rnd_id.first;
-        rnd_counter++;
-      }
-    }
+    build_Q2_one_t(peram, meson_operator, t1, t1/dilT, t1_block, pos,
+                   ql_lookup, ric_lookup, Q2L, false);
     pos++;
   }
   }
 }
-
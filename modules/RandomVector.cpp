@@ -1,5 +1,7 @@
 #include "RandomVector.h"
 
+#include "omp.h"
+
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::RandomVector::set(const size_t entity, const int seed) {
@@ -94,6 +96,7 @@ void LapH::RandomVector::read_random_vector(const std::string& filename) {
 void LapH::RandomVector::read_random_vector(const size_t entity, 
                                             const std::string& filename) {
   // open file for reading
+  #pragma omp critical (cout)
   std::cout << "\tReading random vector from file:\n\t\t" << filename 
             << std::endl;
   FILE *fp = NULL;
@@ -104,6 +107,7 @@ void LapH::RandomVector::read_random_vector(const size_t entity,
   }
   // reading data
   int check_read_in = fread(&(vec[entity*length]), sizeof(cmplx), length, fp);
+  fclose(fp);
   if(check_read_in !=  length)
     std::cout << "It seems that not all data are read from: "
               << filename.c_str() << "\n" << std::endl;
@@ -112,7 +116,8 @@ void LapH::RandomVector::read_random_vector(const size_t entity,
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
 void LapH::RandomVector::read_random_vectors_from_separate_files(
-                                const std::vector<std::string>& filename_list) {
+                                const std::vector<std::string>& filename_list,
+                                const size_t nb_io_threads) {
 
   if(filename_list.size() != nb_entities)
     std::cout << "Problem when reading random vectors: The number of random "
@@ -120,8 +125,17 @@ void LapH::RandomVector::read_random_vectors_from_separate_files(
               << std::endl;
   // set random vector to zero
   std::fill(vec.begin(), vec.end(), cmplx(.0, .0));
+  const double t = omp_get_wtime();
+  #pragma omp parallel for num_threads(nb_io_threads) schedule(dynamic)
   for(size_t i = 0; i < filename_list.size(); i++)
     read_random_vector(i, filename_list[i]);
+  const double time = omp_get_wtime() - t;
+
+  const double mb = filename_list.size() * length * sizeof(cmplx) / 1048576.;
+  std::cout << "\tRead " << filename_list.size() << " random vectors ("
+            << std::fixed << std::setprecision(1) << mb << " MB) with " 
+            << nb_io_threads << " io threads in " << time << " seconds: " 
+            << mb / time << " MB/s" << std::endl;
 }
 // -----------------------------------------------------------------------------
 // -----------------------------------------------------------------------------
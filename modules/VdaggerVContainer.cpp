@@ -0,0 +1,210 @@
+#include "VdaggerVContainer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char magic[8] = {'L', 'A', 'P', 'H', 'V', 'D', 'V', '1'};
+/*! Matrices start at multiples of this, thus each of them is page aligned in
+ *  the mapped file and can be read with O_DIRECT
+ */
+const size_t alignment = 4096;
+
+inline size_t align(const size_t x) {
+  return ((x + alignment - 1) / alignment) * alignment;
+}
+
+/*! Size of magic, nb_ev, Lt and nb_op */
+const size_t fixed_header_size = sizeof(magic) + 3*sizeof(uint64_t);
+
+/******************************************************************************/
+void pwrite_all(const int fd, const void* buf, const size_t nbytes,
+                const size_t offset, const std::string& filename){
+  const char* ptr = static_cast<const char*>(buf);
+  size_t done = 0;
+  while(done < nbytes){
+    const ssize_t res = pwrite(fd, ptr + done, nbytes - done, offset + done);
+    if(res < 0 && errno == EINTR)
+      continue;
+    if(res <= 0){
+      std::cout << "\n\nFailed to write to " << filename << ": "
+                << strerror(errno) << "\n" << std::endl;
+      exit(0);
+    }
+    done += res;
+  }
+}
+
+/******************************************************************************/
+void pread_all(const int fd, void* buf, const size_t nbytes,
+               const size_t offset, const std::string& filename){
+  char* ptr = static_cast<char*>(buf);
+  size_t done = 0;
+  while(done < nbytes){
+    const ssize_t res = pread(fd, ptr + done, nbytes - done, offset + done);
+    if(res < 0 && errno == EINTR)
+      continue;
+    if(res <= 0){
+      std::cout << "\n\nFailed to read from " << filename << ": "
+                << (res == 0 ? "file too short" : strerror(errno)) << "\n"
+                << std::endl;
+      exit(0);
+    }
+    done += res;
+  }
+}
+
+} // end of unnamed namespace
+
+/******************************************************************************/
+/*!
+ *  The whole file is allocated here with ftruncate, thus the matrices can be
+ *  written afterwards in any order and from several threads.
+ */
+std::unique_ptr<LapH::VdaggerVContainer> LapH::VdaggerVContainer::create(
+              const std::string& filename, const size_t nb_ev, const size_t Lt,
+              const std::vector<VdaggerVQuantumNumbers>& vdaggerv_ops) {
+
+  std::unique_ptr<VdaggerVContainer> c(new VdaggerVContainer(filename));
+  c->nb_ev = nb_ev;
+  c->Lt = Lt;
+  for(const auto& op : vdaggerv_ops)
+    c->keys.push_back({{op.momentum[0], op.momentum[1], op.momentum[2],
+                        op.displacement[0], op.displacement[1],
+                        op.displacement[2]}});
+
+  // header
+  const uint64_t sizes[3] = {nb_ev, Lt, vdaggerv_ops.size()};
+  std::vector<int32_t> key_buffer;
+  for(const auto& key : c->keys)
+    key_buffer.insert(key_buffer.end(), key.begin(), key.end());
+  const size_t header_size = fixed_header_size +
+                             key_buffer.size()*sizeof(int32_t) +
+                             c->keys.size()*Lt*sizeof(uint64_t);
+
+  // offsets of the matrices
+  const size_t stride = align(c->matrix_size());
+  c->offsets.resize(c->keys.size()*Lt);
+  for(size_t i = 0; i < c->offsets.size(); i++)
+    c->offsets[i] = align(header_size) + i*stride;
+
+  c->fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(c->fd == -1){
+    std::cout << "failed to open file to write: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  size_t pos = 0;
+  pwrite_all(c->fd, magic, sizeof(magic), pos, filename);
+  pos += sizeof(magic);
+  pwrite_all(c->fd, sizes, sizeof(sizes), pos, filename);
+  pos += sizeof(sizes);
+  pwrite_all(c->fd, key_buffer.data(), key_buffer.size()*sizeof(int32_t), pos,
+             filename);
+  pos += key_buffer.size()*sizeof(int32_t);
+  pwrite_all(c->fd, c->offsets.data(), c->offsets.size()*sizeof(uint64_t), pos,
+             filename);
+  const size_t total = c->offsets.empty() ? align(header_size) :
+                       c->offsets.back() + c->matrix_size();
+  if(ftruncate(c->fd, total) == -1){
+    std::cout << "failed to allocate file: " << filename << "\n" << std::endl;
+    exit(0);
+  }
+  return c;
+}
+
+/******************************************************************************/
+/*!
+ *  The header is checked for the magic and for a file size which fits the
+ *  offset table.
+ */
+std::unique_ptr<LapH::VdaggerVContainer> LapH::VdaggerVContainer::open(
+                                 const std::string& filename, const bool map) {
+
+  std::unique_ptr<VdaggerVContainer> c(new VdaggerVContainer(filename));
+  c->fd = ::open(filename.c_str(), O_RDONLY);
+  if(c->fd == -1){
+    std::cout << "can't open " << filename << std::endl;
+    exit(0);
+  }
+
+  char file_magic[sizeof(magic)];
+  uint64_t sizes[3];
+  pread_all(c->fd, file_magic, sizeof(file_magic), 0, filename);
+  if(memcmp(file_magic, magic, sizeof(magic)) != 0){
+    std::cout << "\n\n" << filename << " is not a VdaggerV container\n"
+              << std::endl;
+    exit(0);
+  }
+  pread_all(c->fd, sizes, sizeof(sizes), sizeof(magic), filename);
+  c->nb_ev = sizes[0];
+  c->Lt = sizes[1];
+
+  std::vector<int32_t> key_buffer(6*sizes[2]);
+  pread_all(c->fd, key_buffer.data(), key_buffer.size()*sizeof(int32_t),
+            fixed_header_size, filename);
+  for(size_t i = 0; i < sizes[2]; i++)
+    c->keys.push_back({{key_buffer[6*i], key_buffer[6*i+1], key_buffer[6*i+2],
+                        key_buffer[6*i+3], key_buffer[6*i+4],
+                        key_buffer[6*i+5]}});
+  c->offsets.resize(sizes[2]*c->Lt);
+  pread_all(c->fd, c->offsets.data(), c->offsets.size()*sizeof(uint64_t),
+            fixed_header_size + key_buffer.size()*sizeof(int32_t), filename);
+
+  struct stat st;
+  if(fstat(c->fd, &st) == -1){
+    std::cout << "failed to get size of file: " << filename << "\n"
+              << std::endl;
+    exit(0);
+  }
+  for(const auto offset : c->offsets)
+    if(offset + c->matrix_size() > size_t(st.st_size)){
+      std::cout << "\n\n" << filename << " is too short for its header\n"
+                << std::endl;
+      exit(0);
+    }
+
+  if(map)
+    c->mapping.reset(new MappedFile(filename));
+  return c;
+}
+
+/******************************************************************************/
+LapH::VdaggerVContainer::~VdaggerVContainer() {
+  if(fd != -1)
+    close(fd);
+}
+
+/******************************************************************************/
+int LapH::VdaggerVContainer::find(const std::array<int, 3>& momentum,
+                                  const std::array<int, 3>& displacement) const {
+  for(size_t i = 0; i < keys.size(); i++)
+    if(std::equal(momentum.begin(), momentum.end(), keys[i].begin()) &&
+       std::equal(displacement.begin(), displacement.end(),
+                  keys[i].begin() + 3))
+      return i;
+  return -1;
+}
+
+/******************************************************************************/
+void LapH::VdaggerVContainer::write(const size_t index, const size_t t,
+                                    const Eigen::MatrixXcd& vdv) {
+  pwrite_all(fd, vdv.data(), matrix_size(), offset(index, t), filename);
+}
+
+/******************************************************************************/
+/*!
+ *  vdv must already have the size nb_ev x nb_ev
+ */
+void LapH::VdaggerVContainer::read(const size_t index, const size_t t,
+                                   Eigen::MatrixXcd& vdv) const {
+  pread_all(fd, vdv.data(), matrix_size(), offset(index, t), filename);
+}
+
+/******************************************************************************/